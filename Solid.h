@@ -0,0 +1,4972 @@
+/*
+ * Authors: Jean-Paul Pelteret, University of Cape Town,
+ *          Andrew McBride, University of Erlangen-Nuremberg, 2010
+ * Modifier: Minhyung Lee (KAIST, mhlee@kaist.ac.kr)
+ */
+
+#ifndef Solid_h
+#define Solid_h
+
+#include "FEM.h"
+#include "util/DirectSolver.h"
+#include "util/Parameters.h"
+#include "util/Telemetry.h"
+
+namespace MLSolver {
+using namespace dealii;
+
+class Time {
+  public:
+    Time(const double time_end, const double delta_t)
+        : timestep(0), time_current(0.0), time_end(time_end), delta_t(delta_t) {
+    }
+
+    virtual ~Time() = default;
+
+    double current() const { return time_current; }
+    double end() const { return time_end; }
+    double get_delta_t() const { return delta_t; }
+    unsigned int get_timestep() const { return timestep; }
+    void increment() {
+        time_current += delta_t;
+        ++timestep;
+    }
+
+    // Sets the size of the next step. A step that would overshoot the end
+    // time or leave only a sliver of it is stretched to end exactly there.
+    void set_delta_t(const double new_delta_t) {
+        delta_t = new_delta_t;
+        if (time_current + 1.01 * delta_t >= time_end)
+            delta_t = time_end - time_current;
+    }
+
+    // Starts a new load history at t = 0.
+    void reset(const double new_time_end, const double new_delta_t) {
+        timestep = 0;
+        time_current = 0.0;
+        time_end = new_time_end;
+        delta_t = new_delta_t;
+    }
+
+    // Moves the current, not yet converged step back to a smaller size.
+    void cut_step(const double new_delta_t) {
+        time_current += new_delta_t - delta_t;
+        delta_t = new_delta_t;
+    }
+
+    template <class Archive>
+    void serialize(Archive &ar, const unsigned int /*version*/) {
+        ar &timestep &time_current &delta_t;
+    }
+
+  private:
+    unsigned int timestep;
+    double time_current;
+    double time_end;
+    double delta_t;
+};
+
+template <int dim> class Material_Compressible_Neo_Hook_Three_Field {
+  public:
+    Material_Compressible_Neo_Hook_Three_Field(const double mu, const double nu)
+        : kappa((2.0 * mu * (1.0 + nu)) / (3.0 * (1.0 - 2.0 * nu))),
+          c_1(mu / 2.0), det_F(1.0), p_tilde(0.0), J_tilde(1.0),
+          b_bar(Physics::Elasticity::StandardTensors<dim>::I) {
+        Assert(kappa > 0,
+               ExcMessage("The parameters mu and nu need to be so that kappa "
+                          "has a positive value."));
+    }
+
+    void update_material_data(const Tensor<2, dim> &F, const double p_tilde_in,
+                              const double J_tilde_in) {
+        det_F = determinant(F);
+        Assert(det_F > 0,
+               ExcMessage("The tensor F must have a positive determinant."));
+
+        const Tensor<2, dim> F_bar = Physics::Elasticity::Kinematics::F_iso(F);
+        b_bar = Physics::Elasticity::Kinematics::b(F_bar);
+        p_tilde = p_tilde_in;
+        J_tilde = J_tilde_in;
+    }
+
+    SymmetricTensor<2, dim> get_tau() { return get_tau_iso() + get_tau_vol(); }
+
+    SymmetricTensor<4, dim> get_Jc() const {
+        return get_Jc_vol() + get_Jc_iso();
+    }
+
+    double get_dPsi_vol_dJ() const {
+        return (kappa / 2.0) * (J_tilde - 1.0 / J_tilde);
+    }
+
+    double get_d2Psi_vol_dJ2() const {
+        return ((kappa / 2.0) * (1.0 + 1.0 / (J_tilde * J_tilde)));
+    }
+
+    double get_det_F() const { return det_F; }
+
+    double get_p_tilde() const { return p_tilde; }
+
+    double get_J_tilde() const { return J_tilde; }
+
+    double get_tr_tau_bar() const { return trace(get_tau_bar()); }
+
+    // Stateless evaluation of the full constitutive response. With Number =
+    // VectorizedArray<double> every SIMD lane carries one quadrature point.
+    // The fictitious elasticity tensor c_bar of this material vanishes and
+    // is therefore not added to Jc, which is only formed if compute_Jc is
+    // set.
+    template <typename Number>
+    void evaluate(const Tensor<2, dim, Number> &F, const Number &p_tilde_in,
+                  const Number &J_tilde_in, const bool compute_Jc,
+                  Tensor<2, dim, Number> &F_inv_out,
+                  SymmetricTensor<2, dim, Number> &tau_out,
+                  SymmetricTensor<4, dim, Number> &Jc_out,
+                  Number &tr_tau_bar_out, Number &det_F_out,
+                  Number &dPsi_vol_dJ_out, Number &d2Psi_vol_dJ2_out) const {
+        const SymmetricTensor<2, dim, Number> I =
+            unit_symmetric_tensor<dim, Number>();
+
+        det_F_out = determinant(F);
+        F_inv_out = invert(F);
+
+        const Tensor<2, dim, Number> F_bar =
+            Physics::Elasticity::Kinematics::F_iso(F);
+        const SymmetricTensor<2, dim, Number> tau_bar =
+            Number(2.0 * c_1) * Physics::Elasticity::Kinematics::b(F_bar);
+        const SymmetricTensor<2, dim, Number> tau_iso = deviator(tau_bar);
+        const Number pJ = p_tilde_in * det_F_out;
+
+        tau_out = tau_iso + pJ * I;
+        tr_tau_bar_out = trace(tau_bar);
+
+        if (compute_Jc)
+            Jc_out = pJ * (outer_product(I, I) -
+                           Number(2.0) * identity_tensor<dim, Number>()) +
+                     Number(2.0 / dim) * tr_tau_bar_out *
+                         deviator_tensor<dim, Number>() -
+                     Number(2.0 / dim) * (outer_product(tau_iso, I) +
+                                          outer_product(I, tau_iso));
+
+        dPsi_vol_dJ_out =
+            Number(kappa / 2.0) * (J_tilde_in - Number(1.0) / J_tilde_in);
+        d2Psi_vol_dJ2_out =
+            Number(kappa / 2.0) *
+            (Number(1.0) + Number(1.0) / (J_tilde_in * J_tilde_in));
+    }
+
+  protected:
+    const double kappa;
+    const double c_1;
+
+    double det_F;
+    double p_tilde;
+    double J_tilde;
+    SymmetricTensor<2, dim> b_bar;
+
+    SymmetricTensor<2, dim> get_tau_vol() const {
+        return p_tilde * det_F * Physics::Elasticity::StandardTensors<dim>::I;
+    }
+
+    SymmetricTensor<2, dim> get_tau_iso() const {
+        return Physics::Elasticity::StandardTensors<dim>::dev_P * get_tau_bar();
+    }
+
+    SymmetricTensor<2, dim> get_tau_bar() const { return 2.0 * c_1 * b_bar; }
+
+    SymmetricTensor<4, dim> get_Jc_vol() const {
+        return p_tilde * det_F *
+               (Physics::Elasticity::StandardTensors<dim>::IxI -
+                (2.0 * Physics::Elasticity::StandardTensors<dim>::S));
+    }
+
+    SymmetricTensor<4, dim> get_Jc_iso() const {
+        const SymmetricTensor<2, dim> tau_bar = get_tau_bar();
+        const SymmetricTensor<2, dim> tau_iso = get_tau_iso();
+        const SymmetricTensor<4, dim> tau_iso_x_I = outer_product(
+            tau_iso, Physics::Elasticity::StandardTensors<dim>::I);
+        const SymmetricTensor<4, dim> I_x_tau_iso = outer_product(
+            Physics::Elasticity::StandardTensors<dim>::I, tau_iso);
+        const SymmetricTensor<4, dim> c_bar = get_c_bar();
+
+        return (2.0 / dim) * trace(tau_bar) *
+                   Physics::Elasticity::StandardTensors<dim>::dev_P -
+               (2.0 / dim) * (tau_iso_x_I + I_x_tau_iso) +
+               Physics::Elasticity::StandardTensors<dim>::dev_P * c_bar *
+                   Physics::Elasticity::StandardTensors<dim>::dev_P;
+    }
+
+    SymmetricTensor<4, dim> get_c_bar() const {
+        return SymmetricTensor<4, dim>();
+    }
+};
+
+// Action of the spatial tangent Jc on a symmetric second-order tensor. With
+// c_bar = 0 the Neo-Hookean tangent reduces to
+//   Jc : eps = (c - 2 p J) eps
+//              + [(p J - c / dim) tr(eps) - 2 / dim (tau_iso : eps)] I
+//              - 2 / dim tr(eps) tau_iso,
+// where c = 2 / dim tr(tau_bar) and tau_iso = tau - p J I, so only tau, p J
+// and tr(tau_bar) have to be stored. If a dense Jc is available it is used
+// instead.
+template <int dim> class SpatialTangent {
+  public:
+    SpatialTangent(const SymmetricTensor<4, dim> *Jc,
+                   const SymmetricTensor<2, dim> &tau, const double pJ,
+                   const double tr_tau_bar)
+        : Jc(Jc),
+          tau_iso(tau - pJ * Physics::Elasticity::StandardTensors<dim>::I),
+          coeff_eps((2.0 / dim) * tr_tau_bar - 2.0 * pJ),
+          coeff_trace(pJ - (2.0 / dim) * tr_tau_bar / dim) {}
+
+    SymmetricTensor<2, dim> apply(const SymmetricTensor<2, dim> &eps) const {
+        if (Jc != nullptr)
+            return *Jc * eps;
+
+        const double tr_eps = trace(eps);
+        SymmetricTensor<2, dim> result =
+            coeff_eps * eps - ((2.0 / dim) * tr_eps) * tau_iso;
+        const double diagonal =
+            coeff_trace * tr_eps - (2.0 / dim) * (tau_iso * eps);
+        for (unsigned int d = 0; d < dim; ++d)
+            result[d][d] += diagonal;
+        return result;
+    }
+
+  private:
+    const SymmetricTensor<4, dim> *const Jc;
+    const SymmetricTensor<2, dim> tau_iso;
+    const double coeff_eps;
+    const double coeff_trace;
+};
+
+// Quadrature point state of all active cells, stored as one contiguous
+// array per quantity and indexed by (active_cell_index, q_point).
+template <int dim> class PointHistory {
+  public:
+    // Non-owning read-only view onto the quadrature points of one cell.
+    class CellData {
+      public:
+        CellData(const PointHistory<dim> &storage, const std::size_t first,
+                 const unsigned int n_q_points)
+            : storage(storage), first(first), n_q_points(n_q_points) {}
+
+        unsigned int size() const { return n_q_points; }
+
+        const Tensor<2, dim> &get_F_inv(const unsigned int q) const {
+            return storage.F_inv[first + q];
+        }
+
+        const SymmetricTensor<2, dim> &get_tau(const unsigned int q) const {
+            return storage.tau[first + q];
+        }
+
+        const SymmetricTensor<4, dim> &get_Jc(const unsigned int q) const {
+            Assert(storage.store_Jc,
+                   ExcMessage("The dense tangent is not stored."));
+            return storage.Jc[first + q];
+        }
+
+        SpatialTangent<dim> get_tangent(const unsigned int q) const {
+            const std::size_t k = first + q;
+            return SpatialTangent<dim>(
+                storage.store_Jc ? &storage.Jc[k] : nullptr, storage.tau[k],
+                storage.p_tilde[k] * storage.det_F[k], storage.tr_tau_bar[k]);
+        }
+
+        double get_det_F(const unsigned int q) const {
+            return storage.det_F[first + q];
+        }
+
+        double get_p_tilde(const unsigned int q) const {
+            return storage.p_tilde[first + q];
+        }
+
+        double get_J_tilde(const unsigned int q) const {
+            return storage.J_tilde[first + q];
+        }
+
+        double get_dPsi_vol_dJ(const unsigned int q) const {
+            return storage.dPsi_vol_dJ[first + q];
+        }
+
+        double get_d2Psi_vol_dJ2(const unsigned int q) const {
+            return storage.d2Psi_vol_dJ2[first + q];
+        }
+
+      private:
+        const PointHistory<dim> &storage;
+        const std::size_t first;
+        const unsigned int n_q_points;
+    };
+
+    PointHistory() : n_q_points(0), store_Jc(true) {}
+
+    void initialize(const unsigned int n_cells,
+                    const unsigned int n_q_points_per_cell,
+                    const Parameters::AllParameters &parameters) {
+        n_q_points = n_q_points_per_cell;
+        store_Jc = (parameters.tangent_form == "dense");
+        const std::size_t n_entries =
+            static_cast<std::size_t>(n_cells) * n_q_points;
+
+        // Every point starts in the undeformed reference state.
+        Material_Compressible_Neo_Hook_Three_Field<dim> material(parameters.mu,
+                                                                 parameters.nu);
+        const Tensor<2, dim> F = Physics::Elasticity::StandardTensors<dim>::I;
+        material.update_material_data(F, 0.0, 1.0);
+
+        // AlignedVector fills in parallel, which also places the pages
+        // with the threads that later update them.
+        const auto assign = [n_entries](auto &values, const auto &value) {
+            values.resize_fast(n_entries);
+            values.fill(value);
+        };
+        assign(F_inv, invert(F));
+        assign(tau, material.get_tau());
+        if (store_Jc)
+            assign(Jc, material.get_Jc());
+        else
+            Jc.clear();
+        assign(tr_tau_bar, material.get_tr_tau_bar());
+        assign(det_F, material.get_det_F());
+        assign(p_tilde, material.get_p_tilde());
+        assign(J_tilde, material.get_J_tilde());
+        assign(dPsi_vol_dJ, material.get_dPsi_vol_dJ());
+        assign(d2Psi_vol_dJ2, material.get_d2Psi_vol_dJ2());
+    }
+
+    template <typename CellIteratorType>
+    CellData get_data(const CellIteratorType &cell) const {
+        const std::size_t first =
+            static_cast<std::size_t>(cell->active_cell_index()) * n_q_points;
+        AssertIndexRange(first, det_F.size());
+        return CellData(*this, first, n_q_points);
+    }
+
+    template <typename CellIteratorType>
+    void update_values(const CellIteratorType &cell, const unsigned int q,
+                       const Tensor<2, dim> &Grad_u_n, const double p_tilde_in,
+                       const double J_tilde_in,
+                       Material_Compressible_Neo_Hook_Three_Field<dim> &material) {
+        const std::size_t k =
+            static_cast<std::size_t>(cell->active_cell_index()) * n_q_points + q;
+        AssertIndexRange(k, det_F.size());
+
+        const Tensor<2, dim> F = Physics::Elasticity::Kinematics::F(Grad_u_n);
+        material.update_material_data(F, p_tilde_in, J_tilde_in);
+
+        F_inv[k] = invert(F);
+        tau[k] = material.get_tau();
+        if (store_Jc)
+            Jc[k] = material.get_Jc();
+        tr_tau_bar[k] = material.get_tr_tau_bar();
+        det_F[k] = material.get_det_F();
+        p_tilde[k] = material.get_p_tilde();
+        J_tilde[k] = material.get_J_tilde();
+        dPsi_vol_dJ[k] = material.get_dPsi_vol_dJ();
+        d2Psi_vol_dJ2[k] = material.get_d2Psi_vol_dJ2();
+    }
+
+    // Updates all quadrature points of a cell, processing
+    // VectorizedArray<double>::size() points per constitutive evaluation.
+    // Unused lanes of the last batch repeat the last point of the cell.
+    template <typename CellIteratorType>
+    void update_cell_values(
+        const CellIteratorType &cell,
+        const std::vector<Tensor<2, dim>> &Grad_u_n,
+        const std::vector<double> &p_tilde_in,
+        const std::vector<double> &J_tilde_in,
+        const Material_Compressible_Neo_Hook_Three_Field<dim> &material) {
+        using VectorType = VectorizedArray<double>;
+        constexpr unsigned int n_lanes = VectorType::size();
+
+        AssertDimension(Grad_u_n.size(), n_q_points);
+        AssertDimension(p_tilde_in.size(), n_q_points);
+        AssertDimension(J_tilde_in.size(), n_q_points);
+
+        const std::size_t first =
+            static_cast<std::size_t>(cell->active_cell_index()) * n_q_points;
+        AssertIndexRange(first + n_q_points - 1, det_F.size());
+
+        Tensor<2, dim, VectorType> F;
+        VectorType p_batch, J_batch;
+        Tensor<2, dim, VectorType> F_inv_batch;
+        SymmetricTensor<2, dim, VectorType> tau_batch;
+        SymmetricTensor<4, dim, VectorType> Jc_batch;
+        VectorType tr_tau_bar_batch, det_F_batch, dPsi_batch, d2Psi_batch;
+
+        for (unsigned int q0 = 0; q0 < n_q_points; q0 += n_lanes) {
+            const unsigned int n_filled = std::min(n_lanes, n_q_points - q0);
+
+            for (unsigned int l = 0; l < n_lanes; ++l) {
+                const unsigned int q = q0 + std::min(l, n_filled - 1);
+                for (unsigned int d = 0; d < dim; ++d)
+                    for (unsigned int e = 0; e < dim; ++e)
+                        F[d][e][l] = Grad_u_n[q][d][e] + (d == e ? 1.0 : 0.0);
+                p_batch[l] = p_tilde_in[q];
+                J_batch[l] = J_tilde_in[q];
+            }
+
+            material.evaluate(F, p_batch, J_batch, store_Jc, F_inv_batch,
+                              tau_batch, Jc_batch, tr_tau_bar_batch,
+                              det_F_batch, dPsi_batch, d2Psi_batch);
+
+            for (unsigned int l = 0; l < n_filled; ++l) {
+                const std::size_t k = first + q0 + l;
+                Assert(det_F_batch[l] > 0,
+                       ExcMessage(
+                           "The tensor F must have a positive determinant."));
+
+                for (unsigned int d = 0; d < dim; ++d)
+                    for (unsigned int e = 0; e < dim; ++e)
+                        F_inv[k][d][e] = F_inv_batch[d][e][l];
+                for (unsigned int c = 0;
+                     c < SymmetricTensor<2, dim>::n_independent_components;
+                     ++c)
+                    tau[k].access_raw_entry(c) =
+                        tau_batch.access_raw_entry(c)[l];
+                if (store_Jc)
+                    for (unsigned int c = 0;
+                         c < SymmetricTensor<4, dim>::n_independent_components;
+                         ++c)
+                        Jc[k].access_raw_entry(c) =
+                            Jc_batch.access_raw_entry(c)[l];
+                tr_tau_bar[k] = tr_tau_bar_batch[l];
+                det_F[k] = det_F_batch[l];
+                p_tilde[k] = p_batch[l];
+                J_tilde[k] = J_batch[l];
+                dPsi_vol_dJ[k] = dPsi_batch[l];
+                d2Psi_vol_dJ2[k] = d2Psi_batch[l];
+            }
+        }
+    }
+
+    template <class Archive>
+    void serialize(Archive &ar, const unsigned int /*version*/) {
+        ar &n_q_points &store_Jc;
+        ar &F_inv &tau &Jc &tr_tau_bar &det_F &p_tilde &J_tilde &dPsi_vol_dJ
+            &d2Psi_vol_dJ2;
+    }
+
+    std::size_t memory_consumption() const {
+        return MemoryConsumption::memory_consumption(F_inv) +
+               MemoryConsumption::memory_consumption(tau) +
+               MemoryConsumption::memory_consumption(Jc) +
+               MemoryConsumption::memory_consumption(tr_tau_bar) +
+               MemoryConsumption::memory_consumption(det_F) +
+               MemoryConsumption::memory_consumption(p_tilde) +
+               MemoryConsumption::memory_consumption(J_tilde) +
+               MemoryConsumption::memory_consumption(dPsi_vol_dJ) +
+               MemoryConsumption::memory_consumption(d2Psi_vol_dJ2);
+    }
+
+  private:
+    unsigned int n_q_points;
+    bool store_Jc;
+
+    AlignedVector<Tensor<2, dim>> F_inv;
+    AlignedVector<SymmetricTensor<2, dim>> tau;
+    AlignedVector<SymmetricTensor<4, dim>> Jc;
+    AlignedVector<double> tr_tau_bar;
+    AlignedVector<double> det_F;
+    AlignedVector<double> p_tilde;
+    AlignedVector<double> J_tilde;
+    AlignedVector<double> dPsi_vol_dJ;
+    AlignedVector<double> d2Psi_vol_dJ2;
+};
+
+// Gradients of the scalar displacement base functions with respect to the
+// reference coordinates, and the JxW values, at every quadrature point of
+// every active cell. The reference geometry does not move, so these only
+// change with the mesh.
+template <int dim> class ReferenceShapeCache {
+  public:
+    ReferenceShapeCache() : n_q_points(0), n_base_functions(0) {}
+
+    void initialize(const Triangulation<dim> &triangulation,
+                    const FiniteElement<dim> &fe_base,
+                    const Quadrature<dim> &qf_cell) {
+        n_q_points = qf_cell.size();
+        n_base_functions = fe_base.n_dofs_per_cell();
+
+        const std::size_t n_entries =
+            static_cast<std::size_t>(triangulation.n_active_cells()) *
+            n_q_points;
+        grad_phi.resize(n_entries * n_base_functions);
+        JxW.resize(n_entries);
+
+        FEValues<dim> fe_values(fe_base, qf_cell,
+                                update_gradients | update_JxW_values);
+        for (const auto &cell : triangulation.active_cell_iterators()) {
+            fe_values.reinit(cell);
+            const std::size_t first =
+                static_cast<std::size_t>(cell->active_cell_index()) *
+                n_q_points;
+            for (unsigned int q = 0; q < n_q_points; ++q) {
+                JxW[first + q] = fe_values.JxW(q);
+                for (unsigned int k = 0; k < n_base_functions; ++k)
+                    grad_phi[(first + q) * n_base_functions + k] =
+                        fe_values.shape_grad(k, q);
+            }
+        }
+    }
+
+    void clear() {
+        std::vector<Tensor<1, dim>>().swap(grad_phi);
+        std::vector<double>().swap(JxW);
+    }
+
+    bool empty() const { return JxW.empty(); }
+
+    // The gradients of all base functions at one quadrature point
+    template <typename CellIteratorType>
+    const Tensor<1, dim> *get_gradients(const CellIteratorType &cell,
+                                        const unsigned int q) const {
+        const std::size_t k =
+            static_cast<std::size_t>(cell->active_cell_index()) * n_q_points +
+            q;
+        AssertIndexRange(k, JxW.size());
+        return &grad_phi[k * n_base_functions];
+    }
+
+    template <typename CellIteratorType>
+    double get_JxW(const CellIteratorType &cell, const unsigned int q) const {
+        const std::size_t k =
+            static_cast<std::size_t>(cell->active_cell_index()) * n_q_points +
+            q;
+        AssertIndexRange(k, JxW.size());
+        return JxW[k];
+    }
+
+    std::size_t memory_consumption() const {
+        return MemoryConsumption::memory_consumption(grad_phi) +
+               MemoryConsumption::memory_consumption(JxW);
+    }
+
+  private:
+    unsigned int n_q_points;
+    unsigned int n_base_functions;
+
+    std::vector<Tensor<1, dim>> grad_phi;
+    std::vector<double> JxW;
+};
+
+// Geometric multigrid V-cycle for the displacement block. The level operators
+// are the condensed tangent of the undeformed body,
+//   2 mu (dev eps(u), dev eps(v)) + kappa (P div u, P div v),
+// with P the L2 projection onto the pressure/dilatation space. This is what
+// K_uu_con reduces to at F = I, so the hierarchy only changes with the mesh.
+// It works on a globally refined mesh without hanging nodes.
+template <int dim> class DisplacementMultigrid {
+  public:
+    DisplacementMultigrid(const unsigned int degree)
+        : fe(FE_Q<dim>(degree), dim), fe_pJ(degree - 1) {}
+
+    // dof_handler_solid must number the displacement dofs first, in one block.
+    void initialize(const DoFHandler<dim> &dof_handler_solid,
+                    const Quadrature<dim> &qf_cell, const double mu,
+                    const double kappa, const unsigned int smoother_degree) {
+        dof_handler.reinit(dof_handler_solid.get_triangulation());
+        dof_handler.distribute_dofs(fe);
+        dof_handler.distribute_mg_dofs();
+
+        setup_dof_map(dof_handler_solid);
+
+        mg_constrained_dofs.initialize(dof_handler);
+        mg_constrained_dofs.make_zero_boundary_constraints(
+            dof_handler, std::set<types::boundary_id>{1});
+        if (dim == 3) {
+            const FEValuesExtractors::Scalar z_displacement(dim - 1);
+            mg_constrained_dofs.make_zero_boundary_constraints(
+                dof_handler, std::set<types::boundary_id>{2, 3},
+                fe.component_mask(z_displacement));
+        }
+
+        assemble_level_matrices(qf_cell, mu, kappa);
+
+        transfer = std::make_unique<MGTransferPrebuilt<Vector<double>>>(
+            mg_constrained_dofs);
+        transfer->build(dof_handler);
+
+        typename Smoother::AdditionalData smoother_data;
+        smoother_data.smoothing_range = 20.0;
+        smoother_data.degree = smoother_degree;
+        smoother_data.eig_cg_n_iterations = 20;
+        smoother.initialize(level_matrices, smoother_data);
+
+        coarse.initialize(level_matrices[0]);
+        mg_matrix.initialize(level_matrices);
+
+        multigrid = std::make_unique<Multigrid<Vector<double>>>(
+            mg_matrix, coarse, *transfer, smoother, smoother);
+        preconditioner = std::make_unique<
+            PreconditionMG<dim, Vector<double>,
+                           MGTransferPrebuilt<Vector<double>>>>(
+            dof_handler, *multigrid, *transfer);
+
+        src_mg.reinit(dof_handler.n_dofs());
+        dst_mg.reinit(dof_handler.n_dofs());
+    }
+
+    unsigned int n_levels() const { return level_matrices.max_level() + 1; }
+
+    // dst and src are in the numbering of the displacement block.
+    void vmult(Vector<double> &dst, const Vector<double> &src) const {
+        for (types::global_dof_index i = 0; i < solid_to_mg.size(); ++i)
+            src_mg[solid_to_mg[i]] = src[i];
+        preconditioner->vmult(dst_mg, src_mg);
+        for (types::global_dof_index i = 0; i < solid_to_mg.size(); ++i)
+            dst[i] = dst_mg[solid_to_mg[i]];
+    }
+
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+        vmult(dst, src);
+    }
+
+  private:
+    using Smoother =
+        PreconditionChebyshev<SparseMatrix<double>, Vector<double>>;
+
+    class CoarseSolver : public MGCoarseGridBase<Vector<double>> {
+      public:
+        void initialize(const SparseMatrix<double> &matrix) {
+            solver.factorize(matrix);
+        }
+
+        void operator()(const unsigned int, Vector<double> &dst,
+                        const Vector<double> &src) const override {
+            solver.vmult(dst, src);
+        }
+
+      private:
+        DirectSolver solver;
+    };
+
+    // Both handlers live on the same triangulation, so their active cells
+    // are visited in the same order; the local dofs are matched through
+    // their (component, base function) pair.
+    void setup_dof_map(const DoFHandler<dim> &dof_handler_solid) {
+        const FiniteElement<dim> &fe_solid = dof_handler_solid.get_fe();
+        std::vector<types::global_dof_index> solid_indices(
+            fe_solid.n_dofs_per_cell());
+        std::vector<types::global_dof_index> mg_indices(fe.n_dofs_per_cell());
+
+        solid_to_mg.assign(dof_handler.n_dofs(), numbers::invalid_dof_index);
+
+        auto solid_cell = dof_handler_solid.begin_active();
+        for (const auto &cell : dof_handler.active_cell_iterators()) {
+            cell->get_dof_indices(mg_indices);
+            solid_cell->get_dof_indices(solid_indices);
+
+            for (unsigned int k = 0; k < fe_solid.n_dofs_per_cell(); ++k) {
+                const auto component_and_base =
+                    fe_solid.system_to_component_index(k);
+                if (component_and_base.first >= dim)
+                    continue;
+
+                AssertIndexRange(solid_indices[k], solid_to_mg.size());
+                solid_to_mg[solid_indices[k]] =
+                    mg_indices[fe.component_to_system_index(
+                        component_and_base.first, component_and_base.second)];
+            }
+            ++solid_cell;
+        }
+    }
+
+    void assemble_level_matrices(const Quadrature<dim> &qf_cell,
+                                 const double mu, const double kappa) {
+        const unsigned int n_levels =
+            dof_handler.get_triangulation().n_global_levels();
+
+        level_sparsity.resize(0, n_levels - 1);
+        level_matrices.resize(0, n_levels - 1);
+
+        FEValues<dim> fe_values(fe, qf_cell,
+                                update_gradients | update_JxW_values);
+        FEValues<dim> fe_values_pJ(fe_pJ, qf_cell, update_values);
+        const FEValuesExtractors::Vector displacement(0);
+
+        const unsigned int n_u = fe.n_dofs_per_cell();
+        const unsigned int n_pJ = fe_pJ.n_dofs_per_cell();
+
+        FullMatrix<double> cell_matrix(n_u, n_u);
+        FullMatrix<double> k_pu(n_pJ, n_u);
+        FullMatrix<double> m_pJ(n_pJ, n_pJ);
+        FullMatrix<double> m_pJ_inv_k_pu(n_pJ, n_u);
+        std::vector<SymmetricTensor<2, dim>> dev_eps(n_u);
+        std::vector<double> div_u(n_u);
+        std::vector<types::global_dof_index> local_dof_indices(n_u);
+
+        for (unsigned int level = 0; level < n_levels; ++level) {
+            DynamicSparsityPattern dsp(dof_handler.n_dofs(level));
+            MGTools::make_sparsity_pattern(dof_handler, dsp, level);
+            level_sparsity[level].copy_from(dsp);
+            level_matrices[level].reinit(level_sparsity[level]);
+
+            AffineConstraints<double> boundary_constraints;
+            boundary_constraints.add_lines(
+                mg_constrained_dofs.get_boundary_indices(level));
+            boundary_constraints.close();
+
+            for (const auto &cell :
+                 dof_handler.mg_cell_iterators_on_level(level)) {
+                fe_values.reinit(cell);
+                fe_values_pJ.reinit(
+                    typename Triangulation<dim>::cell_iterator(cell));
+
+                cell_matrix = 0.0;
+                k_pu = 0.0;
+                m_pJ = 0.0;
+
+                for (const unsigned int q :
+                     fe_values.quadrature_point_indices()) {
+                    const double JxW = fe_values.JxW(q);
+                    for (unsigned int i = 0; i < n_u; ++i) {
+                        const SymmetricTensor<2, dim> eps =
+                            fe_values[displacement].symmetric_gradient(i, q);
+                        div_u[i] = trace(eps);
+                        dev_eps[i] = deviator(eps);
+                    }
+
+                    for (unsigned int i = 0; i < n_u; ++i)
+                        for (unsigned int j = 0; j <= i; ++j)
+                            cell_matrix(i, j) +=
+                                2.0 * mu * (dev_eps[i] * dev_eps[j]) * JxW;
+
+                    for (unsigned int i = 0; i < n_pJ; ++i) {
+                        const double N_i = fe_values_pJ.shape_value(i, q);
+                        for (unsigned int j = 0; j < n_u; ++j)
+                            k_pu(i, j) += N_i * div_u[j] * JxW;
+                        for (unsigned int j = 0; j < n_pJ; ++j)
+                            m_pJ(i, j) +=
+                                N_i * fe_values_pJ.shape_value(j, q) * JxW;
+                    }
+                }
+
+                for (unsigned int i = 0; i < n_u; ++i)
+                    for (unsigned int j = i + 1; j < n_u; ++j)
+                        cell_matrix(i, j) = cell_matrix(j, i);
+
+                // kappa k_pu^T M^-1 k_pu is the condensed volumetric part of
+                // the three-field tangent at p = 0, J = 1.
+                m_pJ.gauss_jordan();
+                m_pJ.mmult(m_pJ_inv_k_pu, k_pu);
+                m_pJ_inv_k_pu *= kappa;
+                k_pu.Tmmult(cell_matrix, m_pJ_inv_k_pu, true);
+
+                cell->get_mg_dof_indices(local_dof_indices);
+                boundary_constraints.distribute_local_to_global(
+                    cell_matrix, local_dof_indices, level_matrices[level]);
+            }
+        }
+    }
+
+    FESystem<dim> fe;
+    FE_DGP<dim> fe_pJ;
+    DoFHandler<dim> dof_handler;
+    MGConstrainedDoFs mg_constrained_dofs;
+
+    MGLevelObject<SparsityPattern> level_sparsity;
+    MGLevelObject<SparseMatrix<double>> level_matrices;
+
+    std::unique_ptr<MGTransferPrebuilt<Vector<double>>> transfer;
+    MGSmootherPrecondition<SparseMatrix<double>, Smoother, Vector<double>>
+        smoother;
+    CoarseSolver coarse;
+    mg::Matrix<Vector<double>> mg_matrix;
+    std::unique_ptr<Multigrid<Vector<double>>> multigrid;
+    std::unique_ptr<
+        PreconditionMG<dim, Vector<double>, MGTransferPrebuilt<Vector<double>>>>
+        preconditioner;
+
+    // Index in dof_handler of every dof of the displacement block
+    std::vector<types::global_dof_index> solid_to_mg;
+
+    mutable Vector<double> src_mg;
+    mutable Vector<double> dst_mg;
+};
+
+// Applies a preconditioner built on a single-precision matrix to
+// double-precision vectors.
+template <typename PreconditionerType> class SinglePrecisionPreconditioner {
+  public:
+    SinglePrecisionPreconditioner(const PreconditionerType &preconditioner)
+        : preconditioner(preconditioner) {}
+
+    void vmult(Vector<double> &dst, const Vector<double> &src) const {
+        src_float = src;
+        dst_float.reinit(src.size(), true);
+        preconditioner.vmult(dst_float, src_float);
+        dst = dst_float;
+    }
+
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+        vmult(dst, src);
+    }
+
+  private:
+    const PreconditionerType &preconditioner;
+
+    mutable Vector<float> src_float;
+    mutable Vector<float> dst_float;
+};
+
+// Inverse of a block-diagonal matrix with one dense, square block per cell,
+// such as K_Jp for the discontinuous pressure and dilatation. vmult() maps
+// the row space of the matrix to its column space; the indices are local to
+// the row and column blocks of the system.
+class CellwiseBlockInverse {
+  public:
+    CellwiseBlockInverse() : n_rows(0), n_cols(0), n_dofs_per_cell(0) {}
+
+    void reinit(const unsigned int n_cells,
+                const unsigned int n_dofs_per_cell_in,
+                const types::global_dof_index n_rows_in,
+                const types::global_dof_index n_cols_in) {
+        n_rows = n_rows_in;
+        n_cols = n_cols_in;
+        n_dofs_per_cell = n_dofs_per_cell_in;
+        inverses.assign(n_cells,
+                        FullMatrix<double>(n_dofs_per_cell, n_dofs_per_cell));
+        row_indices.assign(n_cells * n_dofs_per_cell, 0);
+        col_indices.assign(n_cells * n_dofs_per_cell, 0);
+    }
+
+    void clear() { reinit(0, 0, 0, 0); }
+
+    bool empty() const { return inverses.empty(); }
+
+    void set_cell(const unsigned int cell, const FullMatrix<double> &block,
+                  const std::vector<types::global_dof_index> &rows,
+                  const std::vector<types::global_dof_index> &cols) {
+        AssertIndexRange(cell, inverses.size());
+        inverses[cell].invert(block);
+        std::copy(rows.begin(), rows.end(),
+                  row_indices.begin() + cell * n_dofs_per_cell);
+        std::copy(cols.begin(), cols.end(),
+                  col_indices.begin() + cell * n_dofs_per_cell);
+    }
+
+    types::global_dof_index m() const { return n_cols; }
+
+    types::global_dof_index n() const { return n_rows; }
+
+    void vmult(Vector<double> &dst, const Vector<double> &src) const {
+        apply(dst, src, col_indices, row_indices, false);
+    }
+
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+        apply(dst, src, row_indices, col_indices, true);
+    }
+
+  private:
+    void apply(Vector<double> &dst, const Vector<double> &src,
+               const std::vector<types::global_dof_index> &dst_indices,
+               const std::vector<types::global_dof_index> &src_indices,
+               const bool transpose) const {
+        // Every dof belongs to exactly one cell, so dst is overwritten
+        Vector<double> local_src(n_dofs_per_cell);
+        Vector<double> local_dst(n_dofs_per_cell);
+        for (unsigned int cell = 0; cell < inverses.size(); ++cell) {
+            const std::size_t first =
+                static_cast<std::size_t>(cell) * n_dofs_per_cell;
+            for (unsigned int i = 0; i < n_dofs_per_cell; ++i)
+                local_src(i) = src(src_indices[first + i]);
+            if (transpose)
+                inverses[cell].Tvmult(local_dst, local_src);
+            else
+                inverses[cell].vmult(local_dst, local_src);
+            for (unsigned int i = 0; i < n_dofs_per_cell; ++i)
+                dst(dst_indices[first + i]) = local_dst(i);
+        }
+    }
+
+    types::global_dof_index n_rows;
+    types::global_dof_index n_cols;
+    unsigned int n_dofs_per_cell;
+
+    std::vector<FullMatrix<double>> inverses;
+    std::vector<types::global_dof_index> row_indices;
+    std::vector<types::global_dof_index> col_indices;
+};
+
+// Passes the selected solution fields of the three-field element through to
+// DataOut, so that the others are neither interpolated nor written.
+template <int dim> class SolutionFieldSelector : public DataPostprocessor<dim> {
+  public:
+    SolutionFieldSelector(const bool displacement, const bool pressure,
+                          const bool dilatation) {
+        if (displacement)
+            for (unsigned int d = 0; d < dim; ++d) {
+                components.push_back(d);
+                names.emplace_back("displacement");
+                interpretation.push_back(
+                    DataComponentInterpretation::component_is_part_of_vector);
+            }
+        if (pressure) {
+            components.push_back(dim);
+            names.emplace_back("pressure");
+            interpretation.push_back(
+                DataComponentInterpretation::component_is_scalar);
+        }
+        if (dilatation) {
+            components.push_back(dim + 1);
+            names.emplace_back("dilatation");
+            interpretation.push_back(
+                DataComponentInterpretation::component_is_scalar);
+        }
+    }
+
+    void evaluate_vector_field(
+        const DataPostprocessorInputs::Vector<dim> &inputs,
+        std::vector<Vector<double>> &computed_quantities) const override {
+        for (unsigned int q = 0; q < computed_quantities.size(); ++q)
+            for (unsigned int i = 0; i < components.size(); ++i)
+                computed_quantities[q](i) =
+                    inputs.solution_values[q](components[i]);
+    }
+
+    std::vector<std::string> get_names() const override { return names; }
+
+    std::vector<DataComponentInterpretation::DataComponentInterpretation>
+    get_data_component_interpretation() const override {
+        return interpretation;
+    }
+
+    UpdateFlags get_needed_update_flags() const override {
+        return update_values;
+    }
+
+  private:
+    std::vector<unsigned int> components;
+    std::vector<std::string> names;
+    std::vector<DataComponentInterpretation::DataComponentInterpretation>
+        interpretation;
+};
+
+// Local sizes of the three-field element for a given displacement degree,
+// assuming the usual degree + 1 Gauss rule.
+template <int dim, int fe_degree> struct AssemblyKernelSizes {
+    static constexpr int n_dofs_u =
+        dim * (dim == 2 ? (fe_degree + 1) * (fe_degree + 1)
+                        : (fe_degree + 1) * (fe_degree + 1) * (fe_degree + 1));
+    static constexpr int n_dofs_pJ =
+        (dim == 2 ? fe_degree * (fe_degree + 1) / 2
+                  : fe_degree * (fe_degree + 1) * (fe_degree + 2) / 6);
+    static constexpr int n_q_points = n_dofs_u / dim;
+};
+
+template <int dim> class Solid {
+  public:
+    Solid(const std::string &input_file);
+
+    Solid(const Parameters::AllParameters &parameters);
+
+    ~Solid();
+
+    void run();
+
+    // Runs several load cases on one mesh. Only the material, load and time
+    // parameters may differ between the cases; the grid, dofs, sparsity
+    // pattern, per-cell caches and the symbolic factorization are built once.
+    void run_sweep(const std::vector<Parameters::AllParameters> &cases);
+
+    types::global_dof_index n_dofs() const { return dof_handler.n_dofs(); }
+
+    unsigned int n_active_cells() const {
+        return triangulation.n_active_cells();
+    }
+
+    // Accumulated wall time or number of calls of every timer section
+    std::map<std::string, double>
+    get_timer_summary(const TimerOutput::OutputData kind) const {
+        return timer.get_summary_data(kind);
+    }
+
+  private:
+    struct PerTaskData_ASM;
+    struct ScratchData_ASM;
+
+    struct PerTaskData_SC;
+    struct ScratchData_SC;
+
+    struct PerTaskData_UQPH;
+    struct ScratchData_UQPH;
+
+    struct ScratchData_PP;
+
+    struct PerTaskData_MF;
+    struct ScratchData_MF;
+
+    class TangentBlockOperator;
+    class CondensedTangentOperator;
+
+    void make_grid();
+
+    void read_grid();
+
+    void create_grid();
+
+    void make_grid_cooks();
+
+    void cooks_membrane_grid(const unsigned int);
+
+    void system_setup();
+
+    void set_initial_state();
+
+    static void
+    validate_parameters(const Parameters::AllParameters &parameters);
+
+    void solve_load_steps();
+
+    void refine_and_coarsen_mesh();
+
+    void compute_stress_jump_indicator(Vector<float> &indicator) const;
+
+    void make_constraints(const unsigned int it_nr);
+
+    void make_dirichlet_constraints(AffineConstraints<double> &c) const;
+
+    void wait_for_constraints();
+
+    void assemble_system(const bool assemble_tangent = true);
+
+    void assemble_system_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_ASM &scratch, PerTaskData_ASM &data) const;
+
+    template <int n_dofs_u, int n_dofs_pJ, int n_q>
+    void assemble_system_one_cell_fixed(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_ASM &scratch, PerTaskData_ASM &data) const;
+
+    void assemble_traction_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_ASM &scratch, PerTaskData_ASM &data) const;
+
+    using AssemblyKernel = void (Solid<dim>::*)(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_ASM &scratch, PerTaskData_ASM &data) const;
+
+    template <int fe_degree>
+    AssemblyKernel get_fixed_assembly_kernel() const;
+
+    AssemblyKernel select_assembly_kernel() const;
+
+    void setup_cell_coloring();
+
+    void condense_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_ASM &scratch, PerTaskData_ASM &data);
+
+    void condense_rhs_fused();
+
+    void recover_pJ_fused(BlockVector<double> &newton_update) const;
+
+    void recover_pJ_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_PP &scratch, BlockVector<double> &newton_update) const;
+
+    void assemble_sc();
+
+    void assemble_sc_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_SC &scratch, PerTaskData_SC &data);
+
+    void copy_local_to_global_sc(const PerTaskData_SC &data);
+
+    void setup_qph();
+
+    void make_block_sparsity_pattern(
+        const Table<2, DoFTools::Coupling> &coupling);
+
+    std::uint64_t compute_setup_hash() const;
+
+    std::string get_setup_cache_file() const;
+
+    void write_setup_cache(const std::string &filename) const;
+
+    bool read_setup_cache(const std::string &filename);
+
+    void update_qph_incremental(const BlockVector<double> &solution_delta,
+                                BlockVector<double> *newton_update = nullptr);
+
+    void update_qph_incremental_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        ScratchData_UQPH &scratch, PerTaskData_UQPH &data);
+
+    void copy_local_to_global_UQPH(const PerTaskData_UQPH & /*data*/) {}
+
+    void apply_tangent_block(const unsigned int row_block,
+                             const unsigned int col_block,
+                             Vector<double> &dst,
+                             const Vector<double> &src) const;
+
+    void apply_tangent_block_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        const unsigned int row_block, const unsigned int col_block,
+        const Vector<double> &src, ScratchData_MF &scratch,
+        PerTaskData_MF &data) const;
+
+    void apply_condensed_tangent(Vector<double> &dst,
+                                 const Vector<double> &src) const;
+
+    void apply_condensed_tangent_one_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        const Vector<double> &src, ScratchData_MF &scratch,
+        PerTaskData_MF &data) const;
+
+    void reinit_mf_cell(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        const typename PointHistory<dim>::CellData &lqph,
+        const bool displacement_gradients, ScratchData_MF &scratch) const;
+
+    void setup_tangent_mf();
+
+    const std::vector<types::global_dof_index> &
+    get_element_indices(const unsigned int block) const;
+
+    std::pair<bool, unsigned int>
+    solve_nonlinear_timestep(BlockVector<double> &solution_delta);
+
+    std::pair<unsigned int, double>
+    solve_linear_system(BlockVector<double> &newton_update);
+
+    template <typename MatrixType>
+    void update_direct_factorization(const MatrixType &matrix);
+
+    LinearOperator<Vector<double>>
+    setup_preconditioner_K_uu(const SparseMatrix<double> &K_uu);
+
+    void setup_preconditioner_K_uu_float(const SparseMatrix<double> &K_uu);
+
+    void setup_K_Jp_inverse();
+
+    std::pair<unsigned int, double> solve_K_uu_mixed_precision(
+        Vector<double> &d_u, const Vector<double> &f_u);
+
+    void record_preconditioner_performance(const unsigned int lin_it);
+
+    std::vector<std::vector<double>> compute_rigid_body_modes() const;
+
+    void output_results(const unsigned int timestep);
+
+    bool output_field(const std::string &name) const;
+
+    void wait_for_output();
+
+    std::vector<Point<dim>> get_probe_points() const;
+
+    void locate_probes();
+
+    void write_probes(const unsigned int timestep);
+
+    void save_checkpoint() const;
+
+    void load_checkpoint();
+
+    Parameters::AllParameters parameters;
+
+    double vol_reference;
+
+    Triangulation<dim> triangulation;
+
+    Time time;
+    mutable TimerOutput timer;
+
+    PointHistory<dim> quadrature_point_history;
+
+    const unsigned int degree;
+    const FESystem<dim> fe;
+    DoFHandler<dim> dof_handler;
+    const unsigned int dofs_per_cell;
+
+    static constexpr unsigned int n_blocks = 3;
+    static constexpr unsigned int n_components = dim + 2;
+    static constexpr unsigned int first_u_component = 0;
+    static constexpr unsigned int p_component = dim;
+    static constexpr unsigned int J_component = dim + 1;
+
+    FEValuesExtractors::Vector u_fe =
+        FEValuesExtractors::Vector(first_u_component);
+    FEValuesExtractors::Scalar p_fe = FEValuesExtractors::Scalar(p_component);
+    FEValuesExtractors::Scalar J_fe = FEValuesExtractors::Scalar(J_component);
+
+    enum { u_dof = 0, p_dof = 1, J_dof = 2 };
+
+    std::vector<types::global_dof_index> dofs_per_block;
+    std::vector<types::global_dof_index> element_indices_u;
+    std::vector<types::global_dof_index> element_indices_p;
+    std::vector<types::global_dof_index> element_indices_J;
+    std::vector<unsigned int> element_dof_components;
+    // Index of each local dof within its base element
+    std::vector<unsigned int> element_dof_base_indices;
+
+    ReferenceShapeCache<dim> shape_cache;
+    // p and J shape values at the quadrature points; FE_DGP is defined on
+    // the unit cell, so they are the same on every cell.
+    Table<2, double> reference_Nx;
+
+    AssemblyKernel assembly_kernel;
+
+    // Cells grouped into colors whose members share no (constrained) dofs;
+    // built on first use after every system_setup().
+    std::vector<std::vector<typename DoFHandler<dim>::active_cell_iterator>>
+        colored_cells;
+
+    // Per-cell factors of the fused static condensation, indexed by the
+    // active cell index. They are unconstrained; the constraints are applied
+    // when the condensed contributions are distributed.
+    struct CondensedCellData {
+        FullMatrix<double> k_pu;
+        FullMatrix<double> k_pJ_inv;
+        FullMatrix<double> k_JJ;
+    };
+    std::vector<CondensedCellData> condensed_cells;
+
+    bool use_fused_condensation() const {
+        return parameters.use_static_condensation &&
+               parameters.use_fused_condensation;
+    }
+
+    // With pipelining, the p/J recovery of the fused condensation is done
+    // cell by cell inside the QPH update instead of in a separate pass. BFGS
+    // needs the complete update right after the solve.
+    bool use_pipelined_recovery() const {
+        return parameters.use_pipelining && use_fused_condensation() &&
+               parameters.nonlinear_strategy != "bfgs";
+    }
+
+    const QGauss<dim> qf_cell;
+    const QGauss<dim - 1> qf_face;
+    const unsigned int n_q_points;
+    const unsigned int n_q_points_f;
+
+    AffineConstraints<double> constraints;
+    BlockSparsityPattern sparsity_pattern;
+    BlockSparseMatrix<double> tangent_matrix;
+    BlockVector<double> system_rhs;
+    BlockVector<double> solution_n;
+
+    // Work vectors reused by every Newton iteration instead of being
+    // allocated per call; sized by system_setup().
+    struct ScratchVectors {
+        BlockVector<double> newton_update;
+        BlockVector<double> A;
+        BlockVector<double> B;
+
+        void reinit(const std::vector<types::global_dof_index> &block_sizes) {
+            newton_update.reinit(block_sizes);
+            A.reinit(block_sizes);
+            B.reinit(block_sizes);
+        }
+    } scratch_vectors;
+
+    DirectSolver direct_solver;
+    unsigned int factorization_age;
+    double residual_at_last_solve;
+
+    // Whether the running assembly builds the tangent, and whether the
+    // tangent has been reassembled since the last linear solve. Without
+    // reassembly, the condensed blocks and the factorization stay valid.
+    bool assembling_tangent;
+    bool tangent_updated;
+
+    // Inverse BFGS updates (s_i, y_i, rho_i = 1 / y_i.s_i) on top of the last
+    // assembled tangent, and the rhs of the previous iterate
+    struct QuasiNewtonHistory {
+        std::vector<BlockVector<double>> s;
+        std::vector<BlockVector<double>> y;
+        std::vector<double> rho;
+        BlockVector<double> previous_rhs;
+        bool has_previous = false;
+
+        void clear() {
+            s.clear();
+            y.clear();
+            rho.clear();
+            has_previous = false;
+        }
+    } quasi_newton;
+
+    std::unique_ptr<PreconditionSelector<SparseMatrix<double>, Vector<double>>>
+        preconditioner_selector_K_uu;
+#ifdef DEAL_II_WITH_TRILINOS
+    std::unique_ptr<TrilinosWrappers::PreconditionAMG> preconditioner_amg_K_uu;
+#endif
+    std::unique_ptr<DisplacementMultigrid<dim>> multigrid_K_uu;
+
+    // Single-precision copy of K_uu (K_uu_con with static condensation)
+    // for the mixed-precision modes
+    SparseMatrix<float> K_uu_float;
+    std::unique_ptr<PreconditionSelector<SparseMatrix<float>, Vector<float>>>
+        preconditioner_selector_K_uu_float;
+    std::unique_ptr<SinglePrecisionPreconditioner<
+        PreconditionSelector<SparseMatrix<float>, Vector<float>>>>
+        preconditioner_K_uu_float;
+    unsigned int amg_reference_iterations;
+    bool amg_rebuild_requested;
+
+    Vector<double> diagonal_K_uu_mf;
+
+    // Cell-wise K_pp_bar = K_Jp^-1 K_JJ K_pJ^-1 of the current tangent. p
+    // and J are discontinuous, so the condensed operator
+    // K_uu + K_up K_pp_bar K_pu is applied in a single cell loop.
+    std::vector<FullMatrix<double>> K_pp_bar_mf;
+
+    // K_Jp only depends on the reference mesh, so its cell-wise inverse is
+    // kept until the next call to system_setup().
+    CellwiseBlockInverse K_Jp_inverse;
+    double constrained_diagonal_mf;
+
+    // Background patch building and file writing of the last output; it
+    // returns the report to print once it is joined. The task reads
+    // dof_handler, so the mesh must not change while it is running.
+    Threads::Task<std::string> output_task;
+
+    // A probe point located in the undeformed mesh, with the dofs and the
+    // shape function values of the cell containing it. The cache is valid
+    // until the next call to system_setup().
+    struct Probe {
+        Point<dim> point;
+        bool report;
+        std::vector<types::global_dof_index> dof_indices;
+        std::vector<double> shape_values;
+    };
+    std::vector<Probe> probes;
+    std::ofstream probe_output;
+    std::string probe_filename;
+
+    // Hanging node and Dirichlet constraints of the current mesh. With
+    // pipelining they are built by constraints_task right after
+    // system_setup(), overlapping the initial output, and reused by every
+    // load step until the mesh changes. The task reads dof_handler as well.
+    Threads::Task<void> constraints_task;
+    AffineConstraints<double> dirichlet_constraints;
+    bool dirichlet_constraints_ready;
+
+    // Prepended to the output file names, e.g. to tell sweep cases apart
+    std::string output_prefix;
+
+    Telemetry telemetry;
+
+    struct Errors {
+        Errors() : norm(1.0), u(1.0), p(1.0), J(1.0) {}
+
+        void reset() {
+            norm = 1.0;
+            u = 1.0;
+            p = 1.0;
+            J = 1.0;
+        }
+        void normalize(const Errors &rhs) {
+            if (rhs.norm != 0.0)
+                norm /= rhs.norm;
+            if (rhs.u != 0.0)
+                u /= rhs.u;
+            if (rhs.p != 0.0)
+                p /= rhs.p;
+            if (rhs.J != 0.0)
+                J /= rhs.J;
+        }
+
+        double norm, u, p, J;
+    };
+
+    Errors error_residual, error_residual_0, error_residual_norm, error_update,
+        error_update_0, error_update_norm;
+
+    void get_error_residual(Errors &error_residual);
+
+    void get_error_update(const BlockVector<double> &newton_update,
+                          Errors &error_update);
+
+    std::pair<unsigned int, double>
+    solve_quasi_newton(BlockVector<double> &newton_update);
+
+    double line_search(BlockVector<double> &solution_delta,
+                       BlockVector<double> &newton_update,
+                       const double residual_norm);
+
+    void get_unconstrained_norms(const BlockVector<double> &v,
+                                 Errors &errors) const;
+
+    void write_iteration_telemetry(
+        const unsigned int newton_iteration,
+        const std::pair<unsigned int, double> &lin_solver_output,
+        const std::string &status);
+
+    std::pair<double, double> get_error_dilation() const;
+
+    double compute_vol_current() const;
+
+    static void print_conv_header();
+
+    void print_conv_footer();
+};
+
+template <int dim>
+Solid<dim>::Solid(const std::string &input_file)
+    : Solid(Parameters::AllParameters(input_file)) {}
+
+template <int dim>
+Solid<dim>::Solid(const Parameters::AllParameters &parameters)
+    : parameters(parameters), vol_reference(0.),
+      triangulation(Triangulation<dim>::maximum_smoothing),
+      time(parameters.end_time, parameters.delta_t),
+      timer(std::cout, TimerOutput::summary, TimerOutput::wall_times),
+      degree(parameters.poly_degree),
+      fe(FE_Q<dim>(parameters.poly_degree) ^ dim, // displacement
+         FE_DGP<dim>(parameters.poly_degree - 1), // pressure
+         FE_DGP<dim>(parameters.poly_degree - 1)) // dilatation
+      ,
+      dof_handler(triangulation), dofs_per_cell(fe.n_dofs_per_cell()),
+      dofs_per_block(n_blocks), qf_cell(parameters.quad_order),
+      qf_face(parameters.quad_order), n_q_points(qf_cell.size()),
+      n_q_points_f(qf_face.size()), factorization_age(0),
+      residual_at_last_solve(std::numeric_limits<double>::max()),
+      assembling_tangent(false), tangent_updated(false),
+      amg_reference_iterations(0), amg_rebuild_requested(true),
+      constrained_diagonal_mf(1.0), dirichlet_constraints_ready(false) {
+    Assert(dim == 2 || dim == 3,
+           ExcMessage("This problem only works in 2 or 3 space dimensions."));
+    validate_parameters(parameters);
+
+    for (unsigned int k = 0; k < fe.n_dofs_per_cell(); ++k) {
+        // 자유도가 속한 컴포넌트를 확인
+        const unsigned int component = fe.system_to_component_index(k).first;
+        element_dof_components.push_back(component);
+        element_dof_base_indices.push_back(
+            fe.system_to_component_index(k).second);
+
+        if (component >= first_u_component && component < p_component) // 변위
+            element_indices_u.push_back(k);
+        else if (component == p_component) // 압력
+            element_indices_p.push_back(k);
+        else if (component == J_component) // 팽창
+            element_indices_J.push_back(k);
+        else
+            DEAL_II_ASSERT_UNREACHABLE();
+    }
+
+    // The block-wise assembly loops rely on FESystem numbering the local
+    // displacement dofs first, followed by the pressure and dilatation.
+    AssertThrow(element_indices_u.back() < element_indices_p.front() &&
+                    element_indices_p.back() < element_indices_J.front(),
+                ExcMessage("Unexpected local dof ordering of the FESystem."));
+
+    reference_Nx.reinit(n_q_points, dofs_per_cell);
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        for (const auto k : element_indices_p)
+            reference_Nx[q][k] = fe.shape_value(k, qf_cell.point(q));
+        for (const auto k : element_indices_J)
+            reference_Nx[q][k] = fe.shape_value(k, qf_cell.point(q));
+    }
+
+    assembly_kernel = select_assembly_kernel();
+    std::cout << "Assembly kernel: "
+              << (assembly_kernel == &Solid<dim>::assemble_system_one_cell
+                      ? "generic"
+                      : "fixed size")
+              << std::endl;
+
+    if (!parameters.telemetry_file.empty())
+        telemetry.open(parameters.telemetry_file);
+}
+
+// Rejects option combinations the solver does not support. Runs for the
+// constructor's parameters and for every case of a sweep.
+template <int dim>
+void Solid<dim>::validate_parameters(
+    const Parameters::AllParameters &parameters) {
+    AssertThrow(!parameters.use_matrix_free ||
+                    (parameters.type_lin == "CG" &&
+                     !parameters.use_static_condensation &&
+                     parameters.preconditioner_type == "jacobi"),
+                ExcMessage("The matrix-free tangent requires the CG solver "
+                           "without static condensation and a Jacobi "
+                           "preconditioner."));
+    AssertThrow(parameters.nonlinear_strategy == "newton" ||
+                    !parameters.use_matrix_free,
+                ExcMessage("Modified Newton and BFGS keep an assembled "
+                           "tangent; the matrix-free tangent always follows "
+                           "the current state."));
+    AssertThrow(!parameters.use_adaptive_refinement ||
+                    (!parameters.use_matrix_free &&
+                     (!parameters.use_static_condensation ||
+                      parameters.use_fused_condensation)),
+                ExcMessage("Adaptive refinement requires an assembled tangent "
+                           "and, with static condensation, the fused "
+                           "condensation."));
+    AssertThrow(parameters.mixed_precision == "off" ||
+                    (!parameters.use_matrix_free &&
+                     (parameters.preconditioner_type == "jacobi" ||
+                      parameters.preconditioner_type == "ssor") &&
+                     (parameters.mixed_precision == "preconditioner" ||
+                      parameters.use_static_condensation)),
+                ExcMessage("Mixed precision requires an assembled tangent and "
+                           "a Jacobi or SSOR preconditioner; the single "
+                           "precision solver also requires static "
+                           "condensation."));
+    AssertThrow(parameters.preconditioner_type != "gmg" ||
+                    parameters.mesh_file.empty(),
+                ExcMessage("The multigrid hierarchy is only built for the "
+                           "Cook's membrane grid."));
+    // The coarsest multigrid level has this many times fewer cells per
+    // direction than the mesh that is solved on
+    const unsigned int mg_coarsening = 1U << (parameters.multigrid_levels - 1);
+    AssertThrow(parameters.preconditioner_type != "gmg" ||
+                    (parameters.cellnum % mg_coarsening == 0 &&
+                     (dim == 2 ||
+                      parameters.thickness_layers % mg_coarsening == 0)),
+                ExcMessage("With the multigrid preconditioner the cell num "
+                           "and, in 3-d, the thickness layers must be "
+                           "divisible by 2^(Multigrid levels - 1)."));
+    AssertThrow(parameters.preconditioner_type != "gmg" ||
+                    !parameters.use_adaptive_refinement,
+                ExcMessage("The multigrid preconditioner needs a globally "
+                           "refined mesh and does not work with adaptive "
+                           "refinement."));
+#ifndef DEAL_II_WITH_TRILINOS
+    AssertThrow(parameters.preconditioner_type != "amg",
+                ExcMessage("The AMG preconditioner requires deal.II to be "
+                           "configured with Trilinos."));
+#endif
+}
+
+template <int dim> Solid<dim>::~Solid() {
+    try {
+        if (output_task.joinable())
+            output_task.join();
+        if (constraints_task.joinable())
+            constraints_task.join();
+    } catch (...) {
+    }
+}
+
+template <int dim> void Solid<dim>::run() {
+    if (parameters.restart)
+        load_checkpoint();
+    else {
+        create_grid();
+        system_setup();
+        set_initial_state();
+    }
+
+    solve_load_steps();
+}
+
+template <int dim>
+void Solid<dim>::run_sweep(
+    const std::vector<Parameters::AllParameters> &cases) {
+    AssertThrow(!cases.empty(), ExcMessage("The sweep has no cases."));
+    AssertThrow(!parameters.restart && !parameters.use_adaptive_refinement,
+                ExcMessage("A sweep can neither restart from a checkpoint nor "
+                           "refine the shared mesh."));
+
+    // Everything the mesh, the dof numbering, the sparsity pattern, the
+    // layout of the quadrature point data and the solver objects set up for
+    // the first case depend on
+    const auto same_discretization = [this](const Parameters::AllParameters
+                                                &other) {
+        return other.poly_degree == parameters.poly_degree &&
+               other.quad_order == parameters.quad_order &&
+               other.cellnum == parameters.cellnum &&
+               other.thickness_layers == parameters.thickness_layers &&
+               other.mesh_file == parameters.mesh_file &&
+               other.scale == parameters.scale &&
+               other.use_static_condensation ==
+                   parameters.use_static_condensation &&
+               other.use_fused_condensation ==
+                   parameters.use_fused_condensation &&
+               other.use_matrix_free == parameters.use_matrix_free &&
+               other.use_adaptive_refinement ==
+                   parameters.use_adaptive_refinement &&
+               other.tangent_form == parameters.tangent_form &&
+               other.mixed_precision == parameters.mixed_precision &&
+               other.type_lin == parameters.type_lin &&
+               other.preconditioner_type == parameters.preconditioner_type &&
+               other.nonlinear_strategy == parameters.nonlinear_strategy &&
+               other.telemetry_file == parameters.telemetry_file &&
+               other.multigrid_levels == parameters.multigrid_levels &&
+               other.use_pipelining == parameters.use_pipelining &&
+               !other.restart;
+    };
+    for (const auto &case_parameters : cases) {
+        validate_parameters(case_parameters);
+        AssertThrow(same_discretization(case_parameters),
+                    ExcMessage("All sweep cases must use the discretization "
+                               "and the solver settings the solver was "
+                               "constructed with."));
+    }
+
+    create_grid();
+    system_setup();
+
+    for (unsigned int c = 0; c < cases.size(); ++c) {
+        std::cout << std::endl
+                  << "Sweep case " << c + 1 << " of " << cases.size()
+                  << std::endl;
+
+        if (c > 0) {
+            parameters = cases[c];
+            time.reset(parameters.end_time, parameters.delta_t);
+
+            // The material enters the quadrature point data and the
+            // multigrid level operators; the old numeric factorization
+            // belongs to the previous case.
+            setup_qph();
+            multigrid_K_uu.reset();
+            preconditioner_selector_K_uu.reset();
+#ifdef DEAL_II_WITH_TRILINOS
+            preconditioner_amg_K_uu.reset();
+#endif
+            amg_rebuild_requested = true;
+            factorization_age = parameters.max_factorization_reuse;
+            residual_at_last_solve = std::numeric_limits<double>::max();
+        } else
+            parameters = cases[0];
+
+        output_prefix = "case-" + std::to_string(c) + "-";
+        set_initial_state();
+        solve_load_steps();
+    }
+}
+
+// J = 1 everywhere, u = p = 0; writes the initial output and moves to the
+// first load step.
+template <int dim> void Solid<dim>::set_initial_state() {
+    {
+        AffineConstraints<double> constraints;
+        constraints.close();
+
+        const ComponentSelectFunction<dim> J_mask(J_component, n_components);
+
+        VectorTools::project(dof_handler, constraints, QGauss<dim>(degree + 2),
+                             J_mask, solution_n);
+    }
+    probes.clear();
+    write_probes(time.get_timestep());
+    if (parameters.output_interval > 0)
+        output_results(time.get_timestep());
+    time.increment();
+}
+
+template <int dim> void Solid<dim>::solve_load_steps() {
+    BlockVector<double> solution_delta(dofs_per_block);
+    while (time.current() < time.end()) {
+        solution_delta = 0.0;
+
+        telemetry.begin_phase("timestep");
+        const std::pair<bool, unsigned int> newton_output =
+            solve_nonlinear_timestep(solution_delta);
+        telemetry.end_phase();
+
+        telemetry.add("event", std::string("timestep"));
+        telemetry.add("timestep",
+                      static_cast<unsigned long long>(time.get_timestep()));
+        telemetry.add("time", time.current());
+        telemetry.add("delta_t", time.get_delta_t());
+        telemetry.add("status", std::string(newton_output.first
+                                                ? "converged"
+                                                : "not converged"));
+        telemetry.add("newton_iterations",
+                      static_cast<unsigned long long>(newton_output.second));
+        telemetry.write_record();
+
+        if (!newton_output.first) {
+            const double new_delta_t =
+                parameters.step_cut_factor * time.get_delta_t();
+            AssertThrow(parameters.use_adaptive_time_stepping &&
+                            new_delta_t >= parameters.min_delta_t,
+                        ExcMessage("No convergence in nonlinear solver!"));
+
+            std::cout << "    No convergence, retrying with time step size "
+                      << new_delta_t << std::endl;
+
+            // The quadrature point data is a function of the total solution
+            // only, so resetting it to solution_n undoes the failed attempt.
+            solution_delta = 0.0;
+            update_qph_incremental(solution_delta);
+            residual_at_last_solve = std::numeric_limits<double>::max();
+            time.cut_step(new_delta_t);
+            continue;
+        }
+
+        solution_n += solution_delta;
+
+        const unsigned int timestep = time.get_timestep();
+        write_probes(timestep);
+        if (parameters.use_adaptive_time_stepping)
+            time.set_delta_t(
+                newton_output.second <= parameters.easy_newton_iterations
+                    ? std::min(parameters.step_growth_factor *
+                                   time.get_delta_t(),
+                               parameters.max_delta_t)
+                    : time.get_delta_t());
+        time.increment();
+
+        const bool last_timestep = !(time.current() < time.end());
+        if ((parameters.output_interval > 0 &&
+             timestep % parameters.output_interval == 0) ||
+            (last_timestep && parameters.write_final_output))
+            output_results(timestep);
+
+        if (parameters.use_adaptive_refinement &&
+            timestep % parameters.refinement_interval == 0 &&
+            time.current() < time.end()) {
+            refine_and_coarsen_mesh();
+            solution_delta.reinit(dofs_per_block);
+        }
+
+        if (parameters.checkpoint_interval > 0 &&
+            timestep % parameters.checkpoint_interval == 0)
+            save_checkpoint();
+    }
+    wait_for_output();
+
+    if (parameters.type_lin == "Direct")
+        std::cout << "Direct solver: "
+                  << direct_solver.n_symbolic_factorizations()
+                  << " symbolic and "
+                  << direct_solver.n_numeric_factorizations()
+                  << " numeric factorizations" << std::endl;
+}
+
+// WorkStream keeps a copy of the copy data for every queued cell but only
+// one scratch object per thread, so work space lives in the scratch data.
+template <int dim> struct Solid<dim>::PerTaskData_ASM {
+    FullMatrix<double> cell_matrix;
+    Vector<double> cell_rhs;
+    std::vector<types::global_dof_index> local_dof_indices;
+
+    PerTaskData_ASM(const unsigned int dofs_per_cell)
+        : cell_matrix(dofs_per_cell, dofs_per_cell), cell_rhs(dofs_per_cell),
+          local_dof_indices(dofs_per_cell) {}
+
+    void reset() {
+        cell_matrix = 0.0;
+        cell_rhs = 0.0;
+    }
+};
+
+template <int dim> struct Solid<dim>::ScratchData_ASM {
+    FEValues<dim> fe_values;
+    FEFaceValues<dim> fe_face_values;
+
+    // Indexed by (q_point, dof), each in one contiguous allocation
+    Table<2, double> Nx;
+    Table<2, Tensor<2, dim>> grad_Nx;
+    Table<2, SymmetricTensor<2, dim>> symm_grad_Nx;
+    // Spatial gradients of the displacement base functions
+    std::vector<Tensor<1, dim>> grad_phi_x;
+
+    // Work space of the fused static condensation
+    FullMatrix<double> k_pJ;
+    FullMatrix<double> k_bbar;
+    FullMatrix<double> A;
+    FullMatrix<double> B;
+    FullMatrix<double> C;
+
+    ScratchData_ASM(const FiniteElement<dim> &fe_cell,
+                    const QGauss<dim> &qf_cell, const UpdateFlags uf_cell,
+                    const QGauss<dim - 1> &qf_face, const UpdateFlags uf_face,
+                    const unsigned int n_u, const unsigned int n_p,
+                    const unsigned int n_J)
+        : fe_values(fe_cell, qf_cell, uf_cell),
+          fe_face_values(fe_cell, qf_face, uf_face),
+          Nx(qf_cell.size(), fe_cell.n_dofs_per_cell()),
+          grad_Nx(qf_cell.size(), fe_cell.n_dofs_per_cell()),
+          symm_grad_Nx(qf_cell.size(), fe_cell.n_dofs_per_cell()),
+          grad_phi_x(fe_cell.base_element(0).n_dofs_per_cell()),
+          k_pJ(n_p, n_J), k_bbar(n_u, n_u), A(n_J, n_u), B(n_J, n_u),
+          C(n_p, n_u) {}
+
+    ScratchData_ASM(const ScratchData_ASM &rhs)
+        : fe_values(rhs.fe_values.get_fe(), rhs.fe_values.get_quadrature(),
+                    rhs.fe_values.get_update_flags()),
+          fe_face_values(rhs.fe_face_values.get_fe(),
+                         rhs.fe_face_values.get_quadrature(),
+                         rhs.fe_face_values.get_update_flags()),
+          Nx(rhs.Nx), grad_Nx(rhs.grad_Nx), symm_grad_Nx(rhs.symm_grad_Nx),
+          grad_phi_x(rhs.grad_phi_x), k_pJ(rhs.k_pJ), k_bbar(rhs.k_bbar),
+          A(rhs.A), B(rhs.B), C(rhs.C) {}
+
+    void reset() {
+        Nx.reset_values();
+        grad_Nx.reset_values();
+        symm_grad_Nx.reset_values();
+    }
+};
+
+template <int dim> struct Solid<dim>::PerTaskData_SC {
+    FullMatrix<double> cell_matrix;
+    std::vector<types::global_dof_index> local_dof_indices;
+
+    PerTaskData_SC(const unsigned int dofs_per_cell)
+        : cell_matrix(dofs_per_cell, dofs_per_cell),
+          local_dof_indices(dofs_per_cell) {}
+
+    void reset() {}
+};
+
+template <int dim> struct Solid<dim>::ScratchData_SC {
+    FullMatrix<double> k_orig;
+    FullMatrix<double> k_pu;
+    FullMatrix<double> k_pJ;
+    FullMatrix<double> k_JJ;
+    FullMatrix<double> k_pJ_inv;
+    FullMatrix<double> k_bbar;
+    FullMatrix<double> A;
+    FullMatrix<double> B;
+    FullMatrix<double> C;
+
+    ScratchData_SC(const unsigned int dofs_per_cell, const unsigned int n_u,
+                   const unsigned int n_p, const unsigned int n_J)
+        : k_orig(dofs_per_cell, dofs_per_cell), k_pu(n_p, n_u), k_pJ(n_p, n_J),
+          k_JJ(n_J, n_J), k_pJ_inv(n_p, n_J), k_bbar(n_u, n_u), A(n_J, n_u),
+          B(n_J, n_u), C(n_p, n_u) {}
+
+    void reset() {}
+};
+
+template <int dim> struct Solid<dim>::PerTaskData_UQPH {
+    void reset() {}
+};
+
+template <int dim> struct Solid<dim>::ScratchData_UQPH {
+    const BlockVector<double> &solution_n;
+    const BlockVector<double> &solution_delta;
+    // If set, the p and J entries of this update are recovered on every
+    // cell and the update is included in the total solution.
+    BlockVector<double> *const newton_update;
+
+    std::vector<Tensor<2, dim>> solution_grads_u_total;
+    std::vector<double> solution_values_p_total;
+    std::vector<double> solution_values_J_total;
+    Vector<double> local_dof_values;
+    Vector<double> local_dof_values_delta;
+
+    FEValues<dim> fe_values;
+
+    Material_Compressible_Neo_Hook_Three_Field<dim> material;
+
+    ScratchData_PP recovery;
+
+    ScratchData_UQPH(const FiniteElement<dim> &fe_cell,
+                     const QGauss<dim> &qf_cell, const UpdateFlags uf_cell,
+                     const BlockVector<double> &solution_n,
+                     const BlockVector<double> &solution_delta,
+                     BlockVector<double> *newton_update,
+                     const Parameters::AllParameters &parameters,
+                     const ScratchData_PP &recovery)
+        : solution_n(solution_n), solution_delta(solution_delta),
+          newton_update(newton_update),
+          solution_grads_u_total(qf_cell.size()),
+          solution_values_p_total(qf_cell.size()),
+          solution_values_J_total(qf_cell.size()),
+          local_dof_values(fe_cell.n_dofs_per_cell()),
+          local_dof_values_delta(fe_cell.n_dofs_per_cell()),
+          fe_values(fe_cell, qf_cell, uf_cell),
+          material(parameters.mu, parameters.nu), recovery(recovery) {}
+
+    ScratchData_UQPH(const ScratchData_UQPH &rhs)
+        : solution_n(rhs.solution_n), solution_delta(rhs.solution_delta),
+          newton_update(rhs.newton_update),
+          solution_grads_u_total(rhs.solution_grads_u_total),
+          solution_values_p_total(rhs.solution_values_p_total),
+          solution_values_J_total(rhs.solution_values_J_total),
+          local_dof_values(rhs.local_dof_values),
+          local_dof_values_delta(rhs.local_dof_values_delta),
+          fe_values(rhs.fe_values.get_fe(), rhs.fe_values.get_quadrature(),
+                    rhs.fe_values.get_update_flags()),
+          material(rhs.material), recovery(rhs.recovery) {}
+
+    void reset() {
+        const unsigned int n_q_points = solution_grads_u_total.size();
+        for (unsigned int q = 0; q < n_q_points; ++q) {
+            solution_grads_u_total[q] = 0.0;
+            solution_values_p_total[q] = 0.0;
+            solution_values_J_total[q] = 0.0;
+        }
+    }
+};
+
+// Cell-local vectors of the p/J recovery of the fused condensation
+template <int dim> struct Solid<dim>::ScratchData_PP {
+    std::vector<types::global_dof_index> local_dof_indices;
+    Vector<double> du, f_p, f_J, t_p, t_J, dJ, dp;
+
+    ScratchData_PP(const unsigned int dofs_per_cell, const unsigned int n_u,
+                   const unsigned int n_p, const unsigned int n_J)
+        : local_dof_indices(dofs_per_cell), du(n_u), f_p(n_p), f_J(n_J),
+          t_p(n_p), t_J(n_J), dJ(n_J), dp(n_p) {}
+};
+
+template <int dim> struct Solid<dim>::PerTaskData_MF {
+    Vector<double> cell_dst;
+    std::vector<types::global_dof_index> local_dof_indices;
+
+    PerTaskData_MF(const unsigned int dofs_per_cell)
+        : cell_dst(dofs_per_cell), local_dof_indices(dofs_per_cell) {}
+
+    void reset() { cell_dst = 0.0; }
+};
+
+template <int dim> struct Solid<dim>::ScratchData_MF {
+    FEValues<dim> fe_values;
+    std::vector<double> cell_src;
+
+    // Pushed-forward displacement gradients and JxW of the current cell,
+    // indexed by (q_point, local dof)
+    Table<2, Tensor<2, dim>> grad_Nx;
+    std::vector<Tensor<1, dim>> grad_phi_x;
+    std::vector<double> JxW;
+
+    // Work space of the condensed operator
+    std::vector<Tensor<2, dim>> grad_src;
+    Vector<double> b_p;
+    Vector<double> c_p;
+
+    ScratchData_MF(const FiniteElement<dim> &fe_cell,
+                   const QGauss<dim> &qf_cell, const UpdateFlags uf_cell,
+                   const unsigned int n_p)
+        : fe_values(fe_cell, qf_cell, uf_cell),
+          cell_src(fe_cell.n_dofs_per_cell()),
+          grad_Nx(qf_cell.size(), fe_cell.n_dofs_per_cell()),
+          grad_phi_x(fe_cell.base_element(0).n_dofs_per_cell()),
+          JxW(qf_cell.size()), grad_src(qf_cell.size()), b_p(n_p),
+          c_p(n_p) {}
+
+    ScratchData_MF(const ScratchData_MF &rhs)
+        : fe_values(rhs.fe_values.get_fe(), rhs.fe_values.get_quadrature(),
+                    rhs.fe_values.get_update_flags()),
+          cell_src(rhs.cell_src), grad_Nx(rhs.grad_Nx),
+          grad_phi_x(rhs.grad_phi_x), JxW(rhs.JxW), grad_src(rhs.grad_src),
+          b_p(rhs.b_p), c_p(rhs.c_p) {}
+
+    void reset() { std::fill(cell_src.begin(), cell_src.end(), 0.0); }
+};
+
+template <int dim> class Solid<dim>::TangentBlockOperator {
+  public:
+    TangentBlockOperator(const Solid<dim> &solid, const unsigned int row_block,
+                         const unsigned int col_block)
+        : solid(solid), row_block(row_block), col_block(col_block) {}
+
+    types::global_dof_index m() const {
+        return solid.dofs_per_block[row_block];
+    }
+
+    types::global_dof_index n() const {
+        return solid.dofs_per_block[col_block];
+    }
+
+    void vmult(Vector<double> &dst, const Vector<double> &src) const {
+        dst = 0.0;
+        vmult_add(dst, src);
+    }
+
+    void vmult_add(Vector<double> &dst, const Vector<double> &src) const {
+        solid.apply_tangent_block(row_block, col_block, dst, src);
+    }
+
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+        dst = 0.0;
+        Tvmult_add(dst, src);
+    }
+
+    void Tvmult_add(Vector<double> &dst, const Vector<double> &src) const {
+        solid.apply_tangent_block(col_block, row_block, dst, src);
+    }
+
+  private:
+    const Solid<dim> &solid;
+    const unsigned int row_block;
+    const unsigned int col_block;
+};
+
+// The condensed displacement tangent K_uu + K_up K_pp_bar K_pu; it is
+// symmetric.
+template <int dim> class Solid<dim>::CondensedTangentOperator {
+  public:
+    CondensedTangentOperator(const Solid<dim> &solid) : solid(solid) {}
+
+    types::global_dof_index m() const { return solid.dofs_per_block[u_dof]; }
+
+    types::global_dof_index n() const { return solid.dofs_per_block[u_dof]; }
+
+    void vmult(Vector<double> &dst, const Vector<double> &src) const {
+        dst = 0.0;
+        vmult_add(dst, src);
+    }
+
+    void vmult_add(Vector<double> &dst, const Vector<double> &src) const {
+        solid.apply_condensed_tangent(dst, src);
+    }
+
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+        vmult(dst, src);
+    }
+
+    void Tvmult_add(Vector<double> &dst, const Vector<double> &src) const {
+        vmult_add(dst, src);
+    }
+
+  private:
+    const Solid<dim> &solid;
+};
+
+template <int dim> void Solid<dim>::make_grid() {
+    GridGenerator::hyper_rectangle(
+        triangulation,
+        (dim == 3 ? Point<dim>(0.0, 0.0, 0.0) : Point<dim>(0.0, 0.0)),
+        (dim == 3 ? Point<dim>(1.0, 1.0, 1.0) : Point<dim>(1.0, 1.0)), true);
+    GridTools::scale(parameters.scale, triangulation);
+    triangulation.refine_global(std::max(1U, parameters.global_refinement));
+
+    vol_reference = GridTools::volume(triangulation);
+    std::cout << "Grid:\n\t Reference volume: " << vol_reference << std::endl;
+    int cnt = 0;
+    for (const auto &cell : triangulation.active_cell_iterators())
+        for (const auto &face : cell->face_iterators()) {
+            if (face->at_boundary() == true &&
+                face->center()[1] == 1.0 * parameters.scale) {
+                if (dim == 3) {
+                    if ((0.25 * parameters.scale < face->center()[0] &&
+                         face->center()[0] < 0.75 * parameters.scale) &&
+                        (0.25 * parameters.scale < face->center()[2] &&
+                         face->center()[2] < 0.75 * parameters.scale))
+                        face->set_boundary_id(6);
+                } else {
+                    if (face->center()[0] < 0.5 * parameters.scale)
+                        face->set_boundary_id(6);
+                }
+            }
+        }
+
+    std::cout << cnt << std::endl;
+}
+
+template <int dim> Point<dim> grid_y_transform(const Point<dim> &pt_in) {
+    const double &x = pt_in[0];
+    const double &y = pt_in[1];
+
+    const double y_upper = 44.0 + (16.0 / 48.0) * x; // top edge line
+    const double y_lower = 0.0 + (44.0 / 48.0) * x;  // bottom edge line
+    const double theta = y / 44.0;
+
+    const double y_transform = (1 - theta) * y_lower + theta * y_upper;
+
+    Point<dim> pt_out = pt_in;
+    pt_out[1] = y_transform;
+
+    return pt_out;
+}
+
+template <int dim>
+void Solid<dim>::cooks_membrane_grid(const unsigned int elements_per_edge) {
+
+    // The multigrid hierarchy is built from a coarse grid that is refined
+    // globally to the same mesh that every other preconditioner uses; the
+    // constructor checks that the cell counts are divisible.
+    const unsigned int n_refinements =
+        (parameters.preconditioner_type == "gmg"
+             ? parameters.multigrid_levels - 1
+             : 0);
+
+    std::vector<unsigned int> repetitions(dim,
+                                          elements_per_edge >> n_refinements);
+
+    if (dim == 3) // thickness direction
+        repetitions[2] = parameters.thickness_layers >> n_refinements;
+
+    const Point<dim> bottom_left =
+        (dim == 3 ? Point<dim>(0.0, 0.0, -2.5) : Point<dim>(0.0, 0.0));
+    const Point<dim> top_right =
+        (dim == 3 ? Point<dim>(48.0, 44.0, 2.5) : Point<dim>(48.0, 44.0));
+
+    GridGenerator::subdivided_hyper_rectangle(triangulation, repetitions,
+                                              bottom_left, top_right);
+
+    // Assign boundary IDs
+    const double tol = 1e-6;
+    for (auto cell : triangulation.active_cell_iterators())
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+            if (cell->face(f)->at_boundary()) {
+                const double x = cell->face(f)->center()[0];
+                if (std::abs(x - 0.0) < tol)
+                    cell->face(f)->set_boundary_id(1); // -X
+                else if (std::abs(x - 48.0) < tol && std::abs(x - 48.0) < tol )
+                    cell->face(f)->set_boundary_id(11); // +X
+                else if (dim == 3 &&
+                         std::abs(std::abs(cell->face(f)->center()[2]) - 0.5) <
+                             tol)
+                    cell->face(f)->set_boundary_id(2); // +Z / -Z
+                else
+                    cell->face(f)->set_boundary_id(3);
+            }
+
+    // Transform y-axis for Cook's beam shape
+    GridTools::transform(&grid_y_transform<dim>, triangulation);
+
+    GridTools::scale(parameters.scale, triangulation);
+    triangulation.refine_global(n_refinements);
+
+    vol_reference = GridTools::volume(triangulation);
+    std::cout << "Grid:\n\t Reference volume: " << vol_reference << std::endl;
+
+    std::cout << "Cook's membrane grid created with "
+              << triangulation.n_active_cells() << " active cells."
+              << std::endl;
+}
+
+// Reads the mesh named in the parameters. The boundary ids are taken from
+// the file (Gmsh physical groups, UCD/Abaqus/Exodus side set ids) and have
+// to follow the convention of the Cook's membrane grid: 1 clamped, 2 and 3
+// clamped in z, 11 traction. With a mesh cache, the triangulation is stored
+// in binary form after the first read and loaded from there as long as the
+// cache is newer than the mesh file.
+template <int dim> void Solid<dim>::read_grid() {
+    const std::string &filename = parameters.mesh_file;
+    AssertThrow(std::filesystem::exists(filename),
+                ExcMessage("The mesh file <" + filename + "> does not exist."));
+
+    const std::string &cache = parameters.mesh_cache_file;
+    bool use_cache = !cache.empty() && std::filesystem::exists(cache) &&
+                     std::filesystem::last_write_time(cache) >=
+                         std::filesystem::last_write_time(filename);
+
+    Timer read_timer;
+    if (use_cache) {
+        std::ifstream in(cache, std::ios::binary);
+        boost::archive::binary_iarchive ar(in);
+
+        std::string cached_filename;
+        double cached_scale;
+        ar >> cached_filename >> cached_scale;
+        if (cached_filename == filename && cached_scale == parameters.scale)
+            ar >> triangulation;
+        else {
+            // A cache of another mesh or scale is replaced below
+            std::cout << "Mesh cache " << cache
+                      << " belongs to a different mesh file or scale; "
+                         "reading the mesh file."
+                      << std::endl;
+            use_cache = false;
+        }
+    }
+
+    if (!use_cache) {
+        // GridIn::parse_format() does not know Abaqus and maps .inp to UCD,
+        // so the format is chosen here. Gmsh files go through the Gmsh API
+        // when deal.II is configured with it, which also reads binary .msh
+        // files.
+        std::string format_name = parameters.mesh_format;
+        if (format_name == "auto") {
+            const std::string extension =
+                std::filesystem::path(filename).extension().string();
+            if (extension == ".msh")
+                format_name = "msh";
+            else if (extension == ".inp")
+                format_name = "abaqus";
+            else if (extension == ".ucd")
+                format_name = "ucd";
+            else if (extension == ".vtk")
+                format_name = "vtk";
+            else if (extension == ".vtu")
+                format_name = "vtu";
+            else if (extension == ".e" || extension == ".exo")
+                format_name = "exodusii";
+        }
+
+        typename GridIn<dim>::Format format = GridIn<dim>::Format::Default;
+        if (format_name == "msh")
+            format = GridIn<dim>::Format::msh;
+        else if (format_name == "abaqus")
+            format = GridIn<dim>::Format::abaqus;
+        else if (format_name == "ucd")
+            format = GridIn<dim>::Format::ucd;
+        else if (format_name == "vtk")
+            format = GridIn<dim>::Format::vtk;
+        else if (format_name == "vtu")
+            format = GridIn<dim>::Format::vtu;
+        else if (format_name == "exodusii")
+            format = GridIn<dim>::Format::exodusii;
+
+        GridIn<dim> grid_in;
+        grid_in.attach_triangulation(triangulation);
+        grid_in.read(filename, format);
+        GridTools::scale(parameters.scale, triangulation);
+
+        if (!cache.empty()) {
+            std::ofstream out(cache, std::ios::binary);
+            boost::archive::binary_oarchive ar(out);
+            ar << filename << parameters.scale;
+            ar << triangulation;
+        }
+    }
+    read_timer.stop();
+
+    vol_reference = GridTools::volume(triangulation);
+    std::cout << "Grid:\n\t Reference volume: " << vol_reference << std::endl;
+    std::cout << "Mesh " << filename << " read"
+              << (use_cache ? " from the cache" : "") << " in "
+              << read_timer.wall_time() << " s, "
+              << triangulation.n_active_cells() << " active cells."
+              << std::endl;
+}
+
+template <int dim> void Solid<dim>::create_grid() {
+    if (parameters.mesh_file.empty())
+        cooks_membrane_grid(parameters.cellnum);
+    else
+        read_grid();
+}
+
+template <int dim> void Solid<dim>::system_setup() {
+    wait_for_output();
+    wait_for_constraints();
+    timer.enter_subsection("Setup system");
+
+    probes.clear();
+
+    std::vector<unsigned int> block_component(n_components,
+                                              u_dof); // Displacement
+    block_component[p_component] = p_dof;             // Pressure
+    block_component[J_component] = J_dof;             // Dilatation
+
+    std::cout << "Number of active cells: " << triangulation.n_active_cells()
+              << std::endl;
+    std::cout << "Number of vertices: " << triangulation.n_vertices()
+              << std::endl;
+
+    std::cout << "FE degree: " << fe.degree << std::endl;
+    std::cout << "Number of DOFs per cell: " << fe.n_dofs_per_cell()
+              << std::endl;
+
+    dof_handler.distribute_dofs(fe);
+    const std::string setup_cache = get_setup_cache_file();
+    const bool use_setup_cache =
+        !setup_cache.empty() && read_setup_cache(setup_cache);
+    if (!use_setup_cache) {
+        DoFRenumbering::Cuthill_McKee(dof_handler);
+        DoFRenumbering::component_wise(dof_handler, block_component);
+    }
+
+    dofs_per_block = dofs_per_block =
+        DoFTools::count_dofs_per_fe_block(dof_handler, block_component);
+
+    std::cout << "Triangulation:"
+              << "\n\t Number of active cells: "
+              << triangulation.n_active_cells()
+              << "\n\t Number of degrees of freedom: " << dof_handler.n_dofs()
+              << std::endl;
+
+    preconditioner_K_uu_float.reset();
+    preconditioner_selector_K_uu_float.reset();
+    K_uu_float.clear();
+    tangent_matrix.clear();
+    colored_cells.clear();
+    condensed_cells.clear();
+
+    shape_cache.clear();
+    if (parameters.use_shape_cache) {
+        Timer cache_timer;
+        shape_cache.initialize(triangulation, fe.base_element(0), qf_cell);
+        cache_timer.stop();
+        std::cout << "    Reference shape cache: "
+                  << shape_cache.memory_consumption() / (1024. * 1024.)
+                  << " MB, built in " << cache_timer.wall_time()
+                  << " s (replaces one FEValues::reinit per cell in every "
+                     "assembly and QPH update)"
+                  << std::endl;
+    }
+    if (use_fused_condensation()) {
+        const unsigned int n_u = element_indices_u.size();
+        const unsigned int n_p = element_indices_p.size();
+        const unsigned int n_J = element_indices_J.size();
+
+        condensed_cells.resize(triangulation.n_active_cells());
+        for (auto &cell_data : condensed_cells) {
+            cell_data.k_pu.reinit(n_p, n_u);
+            cell_data.k_pJ_inv.reinit(n_p, n_J);
+            cell_data.k_JJ.reinit(n_J, n_J);
+        }
+    }
+    direct_solver.clear();
+    preconditioner_selector_K_uu.reset();
+#ifdef DEAL_II_WITH_TRILINOS
+    preconditioner_amg_K_uu.reset();
+#endif
+    multigrid_K_uu.reset();
+    K_Jp_inverse.clear();
+    K_pp_bar_mf.clear();
+    amg_rebuild_requested = true;
+    tangent_updated = false;
+
+    // The hanging node constraints shape the sparsity pattern; the
+    // Dirichlet constraints are added by make_constraints().
+    constraints.clear();
+    DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+    constraints.close();
+
+    // The full constraint set for this mesh is built while the sparsity
+    // pattern, the QPH data and the initial output are set up.
+    dirichlet_constraints_ready = false;
+    if (parameters.use_pipelining)
+        constraints_task = Threads::new_task(
+            [this]() { make_dirichlet_constraints(dirichlet_constraints); });
+
+    if (!parameters.use_matrix_free) {
+        Table<2, DoFTools::Coupling> coupling(n_components, n_components);
+        for (unsigned int ii = 0; ii < n_components; ++ii)
+            for (unsigned int jj = 0; jj < n_components; ++jj)
+                if (((ii < p_component) && (jj == J_component)) ||
+                    ((ii == J_component) && (jj < p_component)) ||
+                    ((ii == p_component) && (jj == p_component)))
+                    coupling[ii][jj] = DoFTools::none;
+                else
+                    coupling[ii][jj] = DoFTools::always;
+        if (!use_setup_cache)
+            make_block_sparsity_pattern(coupling);
+
+        tangent_matrix.reinit(sparsity_pattern);
+        if (parameters.mixed_precision != "off")
+            K_uu_float.reinit(sparsity_pattern.block(u_dof, u_dof));
+    }
+
+    if (!setup_cache.empty() && !use_setup_cache)
+        write_setup_cache(setup_cache);
+
+    system_rhs.reinit(dofs_per_block);
+    solution_n.reinit(dofs_per_block);
+    scratch_vectors.reinit(dofs_per_block);
+
+    setup_qph();
+
+    timer.leave_subsection();
+}
+
+// Adapts the mesh to the last converged state and transfers solution_n. The
+// constitutive model has no internal variables, so the quadrature point data
+// is a function of the total solution only; evaluating it afresh from the
+// transferred solution is exact, where projecting the old point values onto
+// the new quadrature points would smear them.
+template <int dim> void Solid<dim>::refine_and_coarsen_mesh() {
+    wait_for_output();
+    wait_for_constraints();
+
+    timer.enter_subsection("Refine mesh");
+    std::cout << std::endl << "Adapting mesh" << std::endl;
+
+    Vector<float> indicator(triangulation.n_active_cells());
+    if (parameters.refinement_indicator == "kelly") {
+        const std::map<types::boundary_id, const Function<dim> *>
+            neumann_boundary;
+        KellyErrorEstimator<dim>::estimate(
+            dof_handler, QGauss<dim - 1>(degree + 1), neumann_boundary,
+            solution_n, indicator, fe.component_mask(u_fe));
+    } else
+        compute_stress_jump_indicator(indicator);
+
+    GridRefinement::refine_and_coarsen_fixed_number(
+        triangulation, indicator, parameters.refine_fraction,
+        parameters.coarsen_fraction);
+    for (const auto &cell : triangulation.active_cell_iterators())
+        if (cell->level() >=
+            static_cast<int>(parameters.max_refinement_level))
+            cell->clear_refine_flag();
+
+    SolutionTransfer<dim, BlockVector<double>> solution_transfer(dof_handler);
+    triangulation.prepare_coarsening_and_refinement();
+    solution_transfer.prepare_for_coarsening_and_refinement(solution_n);
+    triangulation.execute_coarsening_and_refinement();
+    timer.leave_subsection();
+
+    system_setup();
+
+    solution_transfer.interpolate(solution_n);
+    // Only the hanging node constraints are set at this point
+    constraints.distribute(solution_n);
+
+    const BlockVector<double> solution_delta(dofs_per_block);
+    update_qph_incremental(solution_delta);
+    std::cout << std::endl;
+}
+
+// Cell indicator from the jumps of the cell-averaged Kirchhoff stress across
+// interior faces, scaled like a face integral of the squared jump.
+template <int dim>
+void Solid<dim>::compute_stress_jump_indicator(Vector<float> &indicator) const {
+    std::vector<SymmetricTensor<2, dim>> tau_average(
+        triangulation.n_active_cells());
+    for (const auto &cell : triangulation.active_cell_iterators()) {
+        const typename PointHistory<dim>::CellData lqph =
+            quadrature_point_history.get_data(cell);
+        SymmetricTensor<2, dim> &average =
+            tau_average[cell->active_cell_index()];
+        for (unsigned int q = 0; q < n_q_points; ++q)
+            average += qf_cell.weight(q) * lqph.get_tau(q);
+    }
+
+    for (const auto &cell : triangulation.active_cell_iterators()) {
+        const SymmetricTensor<2, dim> &average =
+            tau_average[cell->active_cell_index()];
+        const auto squared_jump = [&](const auto &neighbor) {
+            const double jump =
+                (average - tau_average[neighbor->active_cell_index()]).norm();
+            return jump * jump;
+        };
+
+        double jump_squared = 0.0;
+        for (const unsigned int f : cell->face_indices()) {
+            if (cell->at_boundary(f))
+                continue;
+
+            if (cell->neighbor(f)->is_active())
+                jump_squared += squared_jump(cell->neighbor(f));
+            else
+                for (unsigned int sf = 0; sf < cell->face(f)->n_children();
+                     ++sf)
+                    jump_squared +=
+                        squared_jump(cell->neighbor_child_on_subface(f, sf));
+        }
+
+        indicator[cell->active_cell_index()] =
+            std::pow(cell->diameter(), dim / 2.0) * std::sqrt(jump_squared);
+    }
+}
+
+// Builds sparsity_pattern for the current dof numbering and constraints.
+template <int dim>
+void Solid<dim>::make_block_sparsity_pattern(
+    const Table<2, DoFTools::Coupling> &coupling) {
+    BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
+    DoFTools::make_sparsity_pattern(dof_handler, coupling, dsp, constraints,
+                                    false);
+    sparsity_pattern.copy_from(dsp);
+}
+
+// Hash of what the dof numbering and the sparsity pattern depend on: the
+// connectivity and refinement levels of the active cells, the finite element
+// and whether a matrix is stored at all.
+template <int dim> std::uint64_t Solid<dim>::compute_setup_hash() const {
+    // 64-bit FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto combine = [&hash](const std::uint64_t value) {
+        for (unsigned int byte = 0; byte < 8; ++byte) {
+            hash ^= (value >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    combine(dim);
+    combine(degree);
+    combine(parameters.use_matrix_free);
+    combine(triangulation.n_active_cells());
+    for (const auto &cell : triangulation.active_cell_iterators()) {
+        combine(cell->level());
+        for (const unsigned int v : cell->vertex_indices())
+            combine(cell->vertex_index(v));
+    }
+    return hash;
+}
+
+template <int dim> std::string Solid<dim>::get_setup_cache_file() const {
+    if (parameters.setup_cache_directory.empty())
+        return "";
+
+    std::ostringstream filename;
+    filename << parameters.setup_cache_directory << "/setup-" << std::hex
+             << std::setw(16) << std::setfill('0') << compute_setup_hash()
+             << ".bin";
+    return filename.str();
+}
+
+// Identifies the layout of the setup cache
+static const unsigned int setup_cache_format_version = 1;
+
+// Stores the renumbering from the default numbering of distribute_dofs() to
+// the current one, followed by the blocks of the sparsity pattern.
+template <int dim>
+void Solid<dim>::write_setup_cache(const std::string &filename) const {
+    DoFHandler<dim> default_numbering(triangulation);
+    default_numbering.distribute_dofs(fe);
+
+    std::vector<types::global_dof_index> renumbering(dof_handler.n_dofs());
+    std::vector<types::global_dof_index> old_indices(dofs_per_cell);
+    std::vector<types::global_dof_index> new_indices(dofs_per_cell);
+    auto cell = dof_handler.begin_active();
+    for (const auto &default_cell : default_numbering.active_cell_iterators()) {
+        default_cell->get_dof_indices(old_indices);
+        cell->get_dof_indices(new_indices);
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+            renumbering[old_indices[i]] = new_indices[i];
+        ++cell;
+    }
+
+    std::filesystem::create_directories(parameters.setup_cache_directory);
+    std::ofstream out(filename, std::ios::binary);
+    AssertThrow(out, ExcMessage("Cannot open " + filename));
+    boost::archive::binary_oarchive ar(out);
+
+    const unsigned int format_version = setup_cache_format_version;
+    const std::uint64_t hash = compute_setup_hash();
+    ar << format_version << hash << renumbering;
+    if (!parameters.use_matrix_free)
+        for (unsigned int I = 0; I < n_blocks; ++I)
+            for (unsigned int J = 0; J < n_blocks; ++J)
+                ar << sparsity_pattern.block(I, J);
+
+    std::cout << "    Setup cache written to " << filename << std::endl;
+}
+
+// Applies a cached renumbering to the freshly distributed dofs and reads the
+// sparsity pattern. Returns false if there is no usable cache.
+template <int dim>
+bool Solid<dim>::read_setup_cache(const std::string &filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        return false;
+    boost::archive::binary_iarchive ar(in);
+
+    unsigned int format_version;
+    std::uint64_t hash;
+    std::vector<types::global_dof_index> renumbering;
+    ar >> format_version >> hash;
+    if (format_version != setup_cache_format_version ||
+        hash != compute_setup_hash())
+        return false;
+    ar >> renumbering;
+    if (renumbering.size() != dof_handler.n_dofs())
+        return false;
+
+    dof_handler.renumber_dofs(renumbering);
+    if (!parameters.use_matrix_free) {
+        sparsity_pattern.reinit(n_blocks, n_blocks);
+        for (unsigned int I = 0; I < n_blocks; ++I)
+            for (unsigned int J = 0; J < n_blocks; ++J)
+                ar >> sparsity_pattern.block(I, J);
+        sparsity_pattern.collect_sizes();
+    }
+
+    std::cout << "    Setup read from the cache " << filename << std::endl;
+    return true;
+}
+
+template <int dim> void Solid<dim>::setup_qph() {
+    std::cout << "    Setting up quadrature point data..." << std::endl;
+
+    quadrature_point_history.initialize(triangulation.n_active_cells(),
+                                        n_q_points, parameters);
+
+    std::cout << "    Quadrature point data: "
+              << quadrature_point_history.memory_consumption() / (1024. * 1024.)
+              << " MB" << std::endl;
+}
+
+// With a newton_update, the p/J recovery of the fused condensation runs in
+// the same cell loop and the QPH data is evaluated at
+// solution_n + solution_delta + newton_update.
+template <int dim>
+void Solid<dim>::update_qph_incremental(
+    const BlockVector<double> &solution_delta,
+    BlockVector<double> *newton_update) {
+    timer.enter_subsection("Update QPH data");
+    std::cout << (newton_update ? " PP+UQPH " : " UQPH ") << std::flush;
+
+    const UpdateFlags uf_UQPH(update_values | update_gradients);
+    PerTaskData_UQPH per_task_data_UQPH;
+    ScratchData_UQPH scratch_data_UQPH(
+        fe, qf_cell, uf_UQPH, solution_n, solution_delta, newton_update,
+        parameters,
+        ScratchData_PP(dofs_per_cell, element_indices_u.size(),
+                       element_indices_p.size(), element_indices_J.size()));
+
+    WorkStream::run(dof_handler.active_cell_iterators(), *this,
+                    &Solid::update_qph_incremental_one_cell,
+                    &Solid::copy_local_to_global_UQPH, scratch_data_UQPH,
+                    per_task_data_UQPH);
+
+    timer.leave_subsection();
+}
+
+template <int dim>
+void Solid<dim>::update_qph_incremental_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_UQPH &scratch, PerTaskData_UQPH & /*data*/) {
+    AssertDimension(scratch.solution_grads_u_total.size(), n_q_points);
+    AssertDimension(scratch.solution_values_p_total.size(), n_q_points);
+    AssertDimension(scratch.solution_values_J_total.size(), n_q_points);
+
+    scratch.reset();
+
+    // The total solution solution_n + solution_delta is only formed cell by
+    // cell
+    cell->get_dof_values(scratch.solution_n, scratch.local_dof_values);
+    cell->get_dof_values(scratch.solution_delta,
+                         scratch.local_dof_values_delta);
+    scratch.local_dof_values += scratch.local_dof_values_delta;
+    if (scratch.newton_update) {
+        recover_pJ_one_cell(cell, scratch.recovery, *scratch.newton_update);
+        cell->get_dof_values(*scratch.newton_update,
+                             scratch.local_dof_values_delta);
+        scratch.local_dof_values += scratch.local_dof_values_delta;
+    }
+
+    if (shape_cache.empty()) {
+        scratch.fe_values.reinit(cell);
+        scratch.fe_values[u_fe].get_function_gradients_from_local_dof_values(
+            scratch.local_dof_values, scratch.solution_grads_u_total);
+        scratch.fe_values[p_fe].get_function_values_from_local_dof_values(
+            scratch.local_dof_values, scratch.solution_values_p_total);
+        scratch.fe_values[J_fe].get_function_values_from_local_dof_values(
+            scratch.local_dof_values, scratch.solution_values_J_total);
+    } else {
+        for (unsigned int q = 0; q < n_q_points; ++q) {
+            const Tensor<1, dim> *grad_phi = shape_cache.get_gradients(cell, q);
+            for (const auto k : element_indices_u)
+                scratch.solution_grads_u_total[q][element_dof_components[k]] +=
+                    scratch.local_dof_values(k) *
+                    grad_phi[element_dof_base_indices[k]];
+            for (const auto k : element_indices_p)
+                scratch.solution_values_p_total[q] +=
+                    scratch.local_dof_values(k) * reference_Nx[q][k];
+            for (const auto k : element_indices_J)
+                scratch.solution_values_J_total[q] +=
+                    scratch.local_dof_values(k) * reference_Nx[q][k];
+        }
+    }
+
+    if (parameters.use_vectorized_update)
+        quadrature_point_history.update_cell_values(
+            cell, scratch.solution_grads_u_total,
+            scratch.solution_values_p_total, scratch.solution_values_J_total,
+            scratch.material);
+    else
+        for (const unsigned int q_point :
+             scratch.fe_values.quadrature_point_indices())
+            quadrature_point_history.update_values(
+                cell, q_point, scratch.solution_grads_u_total[q_point],
+                scratch.solution_values_p_total[q_point],
+                scratch.solution_values_J_total[q_point], scratch.material);
+}
+
+// Returns whether Newton converged and the number of iterations it took.
+// Without adaptive time stepping a failure of the linear solver propagates as
+// before; with it, the failure is reported so that the step can be retried.
+template <int dim>
+std::pair<bool, unsigned int>
+Solid<dim>::solve_nonlinear_timestep(BlockVector<double> &solution_delta) {
+    std::cout << std::endl
+              << "Timestep " << time.get_timestep() << " @ " << time.current()
+              << 's' << std::endl;
+
+    BlockVector<double> &newton_update = scratch_vectors.newton_update;
+    newton_update = 0.0;
+
+    error_residual.reset();
+    error_residual_0.reset();
+    error_residual_norm.reset();
+    error_update.reset();
+    error_update_0.reset();
+    error_update_norm.reset();
+
+    print_conv_header();
+
+    quasi_newton.clear();
+    // Set when the line search has left the residual of the current iterate
+    // in system_rhs
+    bool residual_is_current = false;
+    double previous_residual = 0.0;
+
+    unsigned int newton_iteration = 0;
+    for (; newton_iteration < parameters.max_iterations_NR;
+         ++newton_iteration) {
+        std::cout << ' ' << std::setw(2) << newton_iteration << ' '
+                  << std::flush;
+
+        telemetry.begin_phase("constraints");
+        make_constraints(newton_iteration);
+        telemetry.end_phase();
+
+        // Modified Newton and BFGS keep the tangent for as long as every
+        // iteration reduces the residual by the tangent update ratio.
+        const bool may_keep_tangent =
+            parameters.nonlinear_strategy != "newton" && newton_iteration > 0;
+
+        telemetry.begin_phase("assemble");
+        if (!residual_is_current || !may_keep_tangent)
+            assemble_system(!may_keep_tangent);
+        telemetry.end_phase();
+        residual_is_current = false;
+
+        get_error_residual(error_residual);
+        if (newton_iteration == 0)
+            error_residual_0 = error_residual;
+
+        error_residual_norm = error_residual;
+        error_residual_norm.normalize(error_residual_0);
+
+        if (newton_iteration > 0 && error_update_norm.u <= parameters.tol_u &&
+            error_residual_norm.u <= parameters.tol_f) {
+            std::cout << " CONVERGED! " << std::endl;
+            write_iteration_telemetry(newton_iteration, {0, 0.0}, "converged");
+            print_conv_footer();
+
+            return std::make_pair(true, newton_iteration);
+        }
+
+        if (!std::isfinite(error_residual.norm)) {
+            std::cout << " DIVERGED " << std::endl;
+            write_iteration_telemetry(newton_iteration, {0, 0.0}, "diverged");
+            return std::make_pair(false, newton_iteration);
+        }
+
+        if (may_keep_tangent &&
+            error_residual.norm >
+                parameters.tangent_update_ratio * previous_residual) {
+            telemetry.begin_phase("assemble_tangent");
+            assemble_system(true);
+            telemetry.end_phase();
+        }
+        previous_residual = error_residual.norm;
+
+        std::pair<unsigned int, double> lin_solver_output;
+        telemetry.begin_phase("solve");
+        try {
+            if (parameters.nonlinear_strategy == "bfgs")
+                lin_solver_output = solve_quasi_newton(newton_update);
+            else
+                lin_solver_output = solve_linear_system(newton_update);
+        } catch (const SolverControl::NoConvergence &) {
+            if (!parameters.use_adaptive_time_stepping)
+                throw;
+            // The solver threw inside the "Linear solver" subsection
+            timer.leave_subsection();
+            telemetry.end_phase();
+            std::cout << " LINEAR SOLVER FAILED " << std::endl;
+            write_iteration_telemetry(newton_iteration, {0, 0.0},
+                                      "linear solver failed");
+            return std::make_pair(false, newton_iteration);
+        }
+        telemetry.end_phase();
+
+        if (use_pipelined_recovery()) {
+            // The p/J recovery is fused with the QPH update; afterwards the
+            // update norm and the increment only read newton_update and run
+            // concurrently.
+            telemetry.begin_phase("update_qph");
+            update_qph_incremental(solution_delta, &newton_update);
+            telemetry.end_phase();
+
+            Threads::Task<void> error_update_task = Threads::new_task(
+                [&]() { get_error_update(newton_update, error_update); });
+            solution_delta += newton_update;
+            error_update_task.join();
+        } else {
+            get_error_update(newton_update, error_update);
+            solution_delta += newton_update;
+            telemetry.begin_phase("update_qph");
+            update_qph_incremental(solution_delta);
+            telemetry.end_phase();
+        }
+
+        if (parameters.use_line_search) {
+            telemetry.begin_phase("line_search");
+            const double step_length =
+                line_search(solution_delta, newton_update, error_residual.norm);
+            telemetry.end_phase();
+            error_update.norm *= step_length;
+            error_update.u *= step_length;
+            error_update.p *= step_length;
+            error_update.J *= step_length;
+            residual_is_current = true;
+        }
+
+        if (newton_iteration == 0)
+            error_update_0 = error_update;
+
+        error_update_norm = error_update;
+        error_update_norm.normalize(error_update_0);
+
+        write_iteration_telemetry(newton_iteration, lin_solver_output,
+                                  "iterating");
+
+        std::cout << " | " << std::fixed << std::setprecision(3) << std::setw(7)
+                  << std::scientific << lin_solver_output.first << "  "
+                  << lin_solver_output.second << "  "
+                  << error_residual_norm.norm << "  " << error_residual_norm.u
+                  << "  " << error_residual_norm.p << "  "
+                  << error_residual_norm.J << "  " << error_update_norm.norm
+                  << "  " << error_update_norm.u << "  " << error_update_norm.p
+                  << "  " << error_update_norm.J << "  " << std::endl;
+    }
+
+    return std::make_pair(false, newton_iteration);
+}
+
+template <int dim>
+void Solid<dim>::write_iteration_telemetry(
+    const unsigned int newton_iteration,
+    const std::pair<unsigned int, double> &lin_solver_output,
+    const std::string &status) {
+    if (!telemetry.is_enabled())
+        return;
+
+    telemetry.add("event", std::string("newton_iteration"));
+    telemetry.add("timestep",
+                  static_cast<unsigned long long>(time.get_timestep()));
+    telemetry.add("time", time.current());
+    telemetry.add("iteration",
+                  static_cast<unsigned long long>(newton_iteration));
+    telemetry.add("status", status);
+    telemetry.add("n_dofs",
+                  static_cast<unsigned long long>(dof_handler.n_dofs()));
+    telemetry.add("matrix_nnz", static_cast<unsigned long long>(
+                                    parameters.use_matrix_free
+                                        ? 0
+                                        : tangent_matrix.n_nonzero_elements()));
+    telemetry.add("n_threads", static_cast<unsigned long long>(
+                                   MultithreadInfo::n_threads()));
+    telemetry.add("linear_iterations",
+                  static_cast<unsigned long long>(lin_solver_output.first));
+    telemetry.add("linear_residual", lin_solver_output.second);
+    telemetry.add("residual_norm", error_residual_norm.norm);
+    telemetry.add("residual_u", error_residual_norm.u);
+    telemetry.add("residual_p", error_residual_norm.p);
+    telemetry.add("residual_J", error_residual_norm.J);
+    telemetry.add("update_norm", error_update_norm.norm);
+    telemetry.add("update_u", error_update_norm.u);
+    telemetry.add("update_p", error_update_norm.p);
+    telemetry.add("update_J", error_update_norm.J);
+    telemetry.write_record();
+}
+
+template <int dim> void Solid<dim>::print_conv_header() {
+    static const unsigned int l_width = 150;
+
+    for (unsigned int i = 0; i < l_width; ++i)
+        std::cout << '_';
+    std::cout << std::endl;
+
+    std::cout << "               SOLVER STEP               "
+              << " |  LIN_IT   LIN_RES    RES_NORM    "
+              << " RES_U     RES_P      RES_J     NU_NORM     "
+              << " NU_U       NU_P       NU_J " << std::endl;
+
+    for (unsigned int i = 0; i < l_width; ++i)
+        std::cout << '_';
+    std::cout << std::endl;
+}
+
+template <int dim> void Solid<dim>::print_conv_footer() {
+    static const unsigned int l_width = 150;
+
+    for (unsigned int i = 0; i < l_width; ++i)
+        std::cout << '_';
+    std::cout << std::endl;
+
+    const std::pair<double, double> error_dil = get_error_dilation();
+
+    std::cout << "Relative errors:" << std::endl
+              << "Displacement:\t" << error_update.u / error_update_0.u
+              << std::endl
+              << "Force: \t\t" << error_residual.u / error_residual_0.u
+              << std::endl
+              << "Dilatation:\t" << error_dil.first << std::endl
+              << "v / V_0:\t" << error_dil.second * vol_reference << " / "
+              << vol_reference << " = " << error_dil.second << std::endl;
+}
+
+template <int dim> double Solid<dim>::compute_vol_current() const {
+    double vol_current = 0.0;
+
+    FEValues<dim> fe_values(fe, qf_cell, update_JxW_values);
+
+    for (const auto &cell : triangulation.active_cell_iterators()) {
+        fe_values.reinit(cell);
+
+        const typename PointHistory<dim>::CellData lqph =
+            quadrature_point_history.get_data(cell);
+        AssertDimension(lqph.size(), n_q_points);
+
+        for (const unsigned int q_point :
+             fe_values.quadrature_point_indices()) {
+            const double det_F_qp = lqph.get_det_F(q_point);
+            const double JxW = fe_values.JxW(q_point);
+
+            vol_current += det_F_qp * JxW;
+        }
+    }
+    Assert(vol_current > 0.0, ExcInternalError());
+    return vol_current;
+}
+
+template <int dim>
+std::pair<double, double> Solid<dim>::get_error_dilation() const {
+    double dil_L2_error = 0.0;
+
+    FEValues<dim> fe_values(fe, qf_cell, update_JxW_values);
+
+    for (const auto &cell : triangulation.active_cell_iterators()) {
+        fe_values.reinit(cell);
+
+        const typename PointHistory<dim>::CellData lqph =
+            quadrature_point_history.get_data(cell);
+        AssertDimension(lqph.size(), n_q_points);
+
+        for (const unsigned int q_point :
+             fe_values.quadrature_point_indices()) {
+            const double det_F_qp = lqph.get_det_F(q_point);
+            const double J_tilde_qp = lqph.get_J_tilde(q_point);
+            const double the_error_qp_squared =
+                Utilities::fixed_power<2>((det_F_qp - J_tilde_qp));
+            const double JxW = fe_values.JxW(q_point);
+
+            dil_L2_error += the_error_qp_squared * JxW;
+        }
+    }
+
+    return std::make_pair(std::sqrt(dil_L2_error),
+                          compute_vol_current() / vol_reference);
+}
+
+template <int dim> void Solid<dim>::get_error_residual(Errors &error_residual) {
+    get_unconstrained_norms(system_rhs, error_residual);
+}
+
+template <int dim>
+void Solid<dim>::get_error_update(const BlockVector<double> &newton_update,
+                                  Errors &error_update) {
+    get_unconstrained_norms(newton_update, error_update);
+}
+
+// Block-wise l2 norms over the unconstrained dofs, without copying the
+// vector
+template <int dim>
+void Solid<dim>::get_unconstrained_norms(const BlockVector<double> &v,
+                                         Errors &errors) const {
+    double squared_norms[n_blocks] = {0.0, 0.0, 0.0};
+
+    types::global_dof_index dof = 0;
+    for (unsigned int b = 0; b < n_blocks; ++b)
+        for (const double value : v.block(b)) {
+            if (!constraints.is_constrained(dof))
+                squared_norms[b] += value * value;
+            ++dof;
+        }
+
+    errors.norm = std::sqrt(squared_norms[u_dof] + squared_norms[p_dof] +
+                            squared_norms[J_dof]);
+    errors.u = std::sqrt(squared_norms[u_dof]);
+    errors.p = std::sqrt(squared_norms[p_dof]);
+    errors.J = std::sqrt(squared_norms[J_dof]);
+}
+
+// BFGS on top of the last assembled tangent K_0: H_k f_k is formed with the
+// two-loop recursion, where K_0^-1 is applied by solve_linear_system() with
+// a modified rhs. newton_update still holds the previous step, which forms
+// the new secant pair; a reassembled tangent starts a new history.
+template <int dim>
+std::pair<unsigned int, double>
+Solid<dim>::solve_quasi_newton(BlockVector<double> &newton_update) {
+    if (tangent_updated)
+        quasi_newton.clear();
+    else if (quasi_newton.has_previous) {
+        // y = g_k - g_k-1 for the gradient g = -system_rhs
+        BlockVector<double> y(quasi_newton.previous_rhs);
+        y -= system_rhs;
+        const double ys = y * newton_update;
+        // Pairs without positive curvature would make H_k indefinite
+        if (ys > 0.0) {
+            quasi_newton.s.push_back(newton_update);
+            quasi_newton.y.push_back(std::move(y));
+            quasi_newton.rho.push_back(1.0 / ys);
+        }
+    }
+    quasi_newton.previous_rhs = system_rhs;
+    quasi_newton.has_previous = true;
+
+    const unsigned int n_pairs = quasi_newton.s.size();
+    std::vector<double> alpha(n_pairs);
+    for (unsigned int i = n_pairs; i-- > 0;) {
+        alpha[i] = quasi_newton.rho[i] * (quasi_newton.s[i] * system_rhs);
+        system_rhs.add(-alpha[i], quasi_newton.y[i]);
+    }
+
+    const std::pair<unsigned int, double> lin_solver_output =
+        solve_linear_system(newton_update);
+
+    for (unsigned int i = 0; i < n_pairs; ++i) {
+        const double beta =
+            quasi_newton.rho[i] * (quasi_newton.y[i] * newton_update);
+        newton_update.add(alpha[i] - beta, quasi_newton.s[i]);
+    }
+
+    return lin_solver_output;
+}
+
+// Backtracking on the residual norm: the step is halved until
+//   |r(s)| <= (1 - 1e-4 s) |r(0)|
+// or the maximum number of halvings is reached. On entry solution_delta and
+// the QPH data include the full step; on return newton_update is scaled to
+// the accepted step and system_rhs holds its residual.
+template <int dim>
+double Solid<dim>::line_search(BlockVector<double> &solution_delta,
+                               BlockVector<double> &newton_update,
+                               const double residual_norm) {
+    const double sufficient_decrease = 1e-4;
+
+    double step_length = 1.0;
+    for (unsigned int i = 0;; ++i) {
+        assemble_system(false);
+
+        Errors trial;
+        get_error_residual(trial);
+        if (i == parameters.max_line_search_steps ||
+            (std::isfinite(trial.norm) &&
+             trial.norm <=
+                 (1.0 - sufficient_decrease * step_length) * residual_norm))
+            break;
+
+        solution_delta.add(-0.5 * step_length, newton_update);
+        step_length *= 0.5;
+        update_qph_incremental(solution_delta);
+    }
+
+    if (step_length < 1.0) {
+        std::cout << " LS " << step_length << ' ' << std::flush;
+        newton_update *= step_length;
+    }
+
+    return step_length;
+}
+
+// Without assemble_tangent only the residual is assembled; the tangent, the
+// fused condensation factors and the factorization are kept.
+template <int dim>
+void Solid<dim>::assemble_system(const bool assemble_tangent) {
+    timer.enter_subsection("Assemble system");
+    std::cout << (assemble_tangent ? " ASM_SYS " : " ASM_RHS ") << std::flush;
+
+    assembling_tangent = assemble_tangent && !parameters.use_matrix_free;
+    if (assembling_tangent) {
+        tangent_matrix = 0.0;
+        tangent_updated = true;
+    }
+    system_rhs = 0.0;
+
+    const UpdateFlags uf_cell(update_values | update_gradients |
+                              update_JxW_values);
+    const UpdateFlags uf_face(update_values | update_normal_vectors |
+                              update_JxW_values);
+
+    PerTaskData_ASM per_task_data(dofs_per_cell);
+    ScratchData_ASM scratch_data(fe, qf_cell, uf_cell, qf_face, uf_face,
+                                 element_indices_u.size(),
+                                 element_indices_p.size(),
+                                 element_indices_J.size());
+
+    const auto worker =
+        [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+               ScratchData_ASM &scratch, PerTaskData_ASM &data) {
+            (this->*assembly_kernel)(cell, scratch, data);
+            if (assembling_tangent && use_fused_condensation())
+                this->condense_cell(cell, scratch, data);
+        };
+    const auto copier = [this](const PerTaskData_ASM &data) {
+        if (!assembling_tangent)
+            this->constraints.distribute_local_to_global(
+                data.cell_rhs, data.local_dof_indices, system_rhs);
+        else
+            this->constraints.distribute_local_to_global(
+                data.cell_matrix, data.cell_rhs, data.local_dof_indices,
+                tangent_matrix, system_rhs);
+    };
+
+    if (parameters.use_colored_assembly) {
+        if (colored_cells.empty())
+            setup_cell_coloring();
+        WorkStream::run(colored_cells, worker, copier, scratch_data,
+                        per_task_data);
+    } else
+        WorkStream::run(dof_handler.active_cell_iterators(), worker, copier,
+                        scratch_data, per_task_data);
+
+    timer.leave_subsection();
+}
+
+// Colors the active cells such that no two cells of a color write to the
+// same global row. Besides the cell's own dofs, the dofs its constrained
+// dofs are distributed to count as conflicts.
+template <int dim> void Solid<dim>::setup_cell_coloring() {
+    using CellIterator = typename DoFHandler<dim>::active_cell_iterator;
+
+    const std::function<std::vector<types::global_dof_index>(
+        const CellIterator &)>
+        get_conflict_indices = [this](const CellIterator &cell) {
+            std::vector<types::global_dof_index> indices(dofs_per_cell);
+            cell->get_dof_indices(indices);
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                if (const auto *entries =
+                        constraints.get_constraint_entries(indices[i]))
+                    for (const auto &entry : *entries)
+                        indices.push_back(entry.first);
+            return indices;
+        };
+
+    colored_cells = GraphColoring::make_graph_coloring(
+        dof_handler.begin_active(), dof_handler.end(), get_conflict_indices);
+
+    std::cout << "    Assembly colors: " << colored_cells.size() << std::endl;
+}
+
+template <int dim>
+void Solid<dim>::assemble_system_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_ASM &scratch, PerTaskData_ASM &data) const {
+    const bool use_shape_cache = !shape_cache.empty();
+
+    data.reset();
+    scratch.reset();
+    if (!use_shape_cache)
+        scratch.fe_values.reinit(cell);
+    cell->get_dof_indices(data.local_dof_indices);
+
+    const typename PointHistory<dim>::CellData lqph =
+        quadrature_point_history.get_data(cell);
+    AssertDimension(lqph.size(), n_q_points);
+
+    for (const unsigned int q_point :
+         scratch.fe_values.quadrature_point_indices()) {
+        const Tensor<2, dim> F_inv = lqph.get_F_inv(q_point);
+        if (use_shape_cache) {
+            // Push the base gradients forward once and place them in the
+            // row of each dof's component.
+            const Tensor<1, dim> *grad_phi =
+                shape_cache.get_gradients(cell, q_point);
+            for (unsigned int b = 0; b < scratch.grad_phi_x.size(); ++b)
+                scratch.grad_phi_x[b] = grad_phi[b] * F_inv;
+            for (const auto k : element_indices_u) {
+                scratch.grad_Nx[q_point][k][element_dof_components[k]] =
+                    scratch.grad_phi_x[element_dof_base_indices[k]];
+                scratch.symm_grad_Nx[q_point][k] =
+                    symmetrize(scratch.grad_Nx[q_point][k]);
+            }
+            for (const auto k : element_indices_p)
+                scratch.Nx[q_point][k] = reference_Nx[q_point][k];
+            for (const auto k : element_indices_J)
+                scratch.Nx[q_point][k] = reference_Nx[q_point][k];
+        } else {
+            for (const auto k : element_indices_u) {
+                scratch.grad_Nx[q_point][k] =
+                    scratch.fe_values[u_fe].gradient(k, q_point) * F_inv;
+                scratch.symm_grad_Nx[q_point][k] =
+                    symmetrize(scratch.grad_Nx[q_point][k]);
+            }
+            for (const auto k : element_indices_p)
+                scratch.Nx[q_point][k] =
+                    scratch.fe_values[p_fe].value(k, q_point);
+            for (const auto k : element_indices_J)
+                scratch.Nx[q_point][k] =
+                    scratch.fe_values[J_fe].value(k, q_point);
+        }
+    }
+
+    const unsigned int n_u = element_indices_u.size();
+    const unsigned int n_J = element_indices_J.size();
+
+    for (const unsigned int q_point :
+         scratch.fe_values.quadrature_point_indices()) {
+        const SymmetricTensor<2, dim> tau = lqph.get_tau(q_point);
+        const Tensor<2, dim> tau_ns = lqph.get_tau(q_point);
+        const SpatialTangent<dim> Jc = lqph.get_tangent(q_point);
+        const double det_F = lqph.get_det_F(q_point);
+        const double p_tilde = lqph.get_p_tilde(q_point);
+        const double J_tilde = lqph.get_J_tilde(q_point);
+        const double dPsi_vol_dJ = lqph.get_dPsi_vol_dJ(q_point);
+        const double d2Psi_vol_dJ2 = lqph.get_d2Psi_vol_dJ2(q_point);
+
+        const ArrayView<const double> N = make_array_view(scratch.Nx, q_point);
+        const ArrayView<const SymmetricTensor<2, dim>> symm_grad_Nx =
+            make_array_view(scratch.symm_grad_Nx, q_point);
+        const ArrayView<const Tensor<2, dim>> grad_Nx =
+            make_array_view(scratch.grad_Nx, q_point);
+        const double JxW = use_shape_cache ? shape_cache.get_JxW(cell, q_point)
+                                           : scratch.fe_values.JxW(q_point);
+
+        for (const auto i : element_indices_u)
+            data.cell_rhs(i) -= (symm_grad_Nx[i] * tau) * JxW;
+        for (const auto i : element_indices_p)
+            data.cell_rhs(i) -= N[i] * (det_F - J_tilde) * JxW;
+        for (const auto i : element_indices_J)
+            data.cell_rhs(i) -= N[i] * (dPsi_vol_dJ - p_tilde) * JxW;
+
+        if (!assembling_tangent)
+            continue;
+
+        // Local dofs are ordered u, p, J, so every block below lies in the
+        // lower triangle and is mirrored at the end.
+        for (unsigned int ii = 0; ii < n_u; ++ii) // UU block
+        {
+            const unsigned int i = element_indices_u[ii];
+            const unsigned int component_i = element_dof_components[i];
+            const SymmetricTensor<2, dim> symm_grad_Nx_i_x_Jc =
+                Jc.apply(symm_grad_Nx[i]);
+            const Tensor<1, dim> grad_Nx_i_comp_i_x_tau =
+                grad_Nx[i][component_i] * tau_ns;
+
+            for (unsigned int jj = 0; jj <= ii; ++jj) {
+                const unsigned int j = element_indices_u[jj];
+                data.cell_matrix(i, j) +=
+                    symm_grad_Nx_i_x_Jc * symm_grad_Nx[j] * JxW;
+
+                if (component_i == element_dof_components[j])
+                    data.cell_matrix(i, j) += grad_Nx_i_comp_i_x_tau *
+                                              grad_Nx[j][component_i] * JxW;
+            }
+        }
+
+        for (const auto i : element_indices_p) // PU block
+        {
+            const double N_i_x_det_F_x_JxW = N[i] * det_F * JxW;
+            for (const auto j : element_indices_u)
+                data.cell_matrix(i, j) +=
+                    N_i_x_det_F_x_JxW * trace(symm_grad_Nx[j]);
+        }
+
+        for (const auto i : element_indices_J) // JP block
+            for (const auto j : element_indices_p)
+                data.cell_matrix(i, j) -= N[i] * N[j] * JxW;
+
+        for (unsigned int ii = 0; ii < n_J; ++ii) // JJ block
+        {
+            const unsigned int i = element_indices_J[ii];
+            for (unsigned int jj = 0; jj <= ii; ++jj) {
+                const unsigned int j = element_indices_J[jj];
+                data.cell_matrix(i, j) += N[i] * d2Psi_vol_dJ2 * N[j] * JxW;
+            }
+        }
+    }
+
+    assemble_traction_one_cell(cell, scratch, data);
+
+    for (const unsigned int i : scratch.fe_values.dof_indices())
+        for (const unsigned int j :
+             scratch.fe_values.dof_indices_starting_at(i + 1))
+            data.cell_matrix(i, j) = data.cell_matrix(j, i);
+}
+
+template <int dim>
+void Solid<dim>::assemble_traction_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_ASM &scratch, PerTaskData_ASM &data) const {
+    for (const auto &face : cell->face_iterators())
+        if (face->at_boundary() && face->boundary_id() == 11) {
+            scratch.fe_face_values.reinit(cell, face);
+
+            for (const unsigned int f_q_point :
+                 scratch.fe_face_values.quadrature_point_indices()) {
+                const Tensor<1, dim> &N =
+                    scratch.fe_face_values.normal_vector(f_q_point);
+
+                Tensor<1, dim> dir;
+                dir[1] = 0.0625;
+                //                const Tensor<1, dim> traction = 1.0 * dir;
+
+                static const double p0 =
+                    1.0 / (parameters.scale * parameters.scale);
+                const double time_ramp = (time.current() / time.end());
+                const double pressure = p0 * parameters.p_p0 * time_ramp;
+                const Tensor<1, dim> traction = pressure * dir;
+                const double JxW = scratch.fe_face_values.JxW(f_q_point);
+
+                for (const auto i : element_indices_u) {
+                    const unsigned int component_i = element_dof_components[i];
+                    const double Ni =
+                        scratch.fe_face_values.shape_value(i, f_q_point);
+
+                    data.cell_rhs(i) += (Ni * traction[component_i]) * JxW;
+                }
+            }
+        }
+}
+
+template <int dim>
+template <int n_dofs_u, int n_dofs_pJ, int n_q>
+void Solid<dim>::assemble_system_one_cell_fixed(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_ASM &scratch, PerTaskData_ASM &data) const {
+    // Local dofs are numbered u, p, J (see the constructor), so the block
+    // offsets are compile-time constants.
+    constexpr int p_start = n_dofs_u;
+    constexpr int J_start = n_dofs_u + n_dofs_pJ;
+    AssertDimension(dofs_per_cell, n_dofs_u + 2 * n_dofs_pJ);
+    AssertDimension(n_q_points, n_q);
+
+    const bool use_shape_cache = !shape_cache.empty();
+
+    data.reset();
+    if (!use_shape_cache)
+        scratch.fe_values.reinit(cell);
+    cell->get_dof_indices(data.local_dof_indices);
+
+    const typename PointHistory<dim>::CellData lqph =
+        quadrature_point_history.get_data(cell);
+    AssertDimension(lqph.size(), n_q_points);
+
+    std::array<Tensor<2, dim>, n_dofs_u> grad_Nx;
+    std::array<SymmetricTensor<2, dim>, n_dofs_u> symm_grad_Nx;
+    std::array<double, n_dofs_pJ> N_p;
+    std::array<double, n_dofs_pJ> N_J;
+    std::array<Tensor<1, dim>, n_dofs_u / dim> grad_phi_x;
+
+    std::array<double, n_dofs_pJ * n_dofs_u> k_pu{};
+    std::array<double, n_dofs_pJ * n_dofs_pJ> k_Jp{};
+    std::array<double, n_dofs_pJ * n_dofs_pJ> k_JJ{};
+
+    for (int q_point = 0; q_point < n_q; ++q_point) {
+        const Tensor<2, dim> &F_inv = lqph.get_F_inv(q_point);
+        const SymmetricTensor<2, dim> &tau = lqph.get_tau(q_point);
+        const Tensor<2, dim> tau_ns = tau;
+        const SpatialTangent<dim> Jc = lqph.get_tangent(q_point);
+        const double det_F = lqph.get_det_F(q_point);
+        const double p_tilde = lqph.get_p_tilde(q_point);
+        const double J_tilde = lqph.get_J_tilde(q_point);
+        const double dPsi_vol_dJ = lqph.get_dPsi_vol_dJ(q_point);
+        const double d2Psi_vol_dJ2 = lqph.get_d2Psi_vol_dJ2(q_point);
+
+        double JxW;
+        if (use_shape_cache) {
+            JxW = shape_cache.get_JxW(cell, q_point);
+            const Tensor<1, dim> *grad_phi =
+                shape_cache.get_gradients(cell, q_point);
+            for (int b = 0; b < n_dofs_u / dim; ++b)
+                grad_phi_x[b] = grad_phi[b] * F_inv;
+            for (int i = 0; i < n_dofs_u; ++i) {
+                grad_Nx[i] = 0.0;
+                grad_Nx[i][element_dof_components[i]] =
+                    grad_phi_x[element_dof_base_indices[i]];
+                symm_grad_Nx[i] = symmetrize(grad_Nx[i]);
+            }
+            for (int i = 0; i < n_dofs_pJ; ++i) {
+                N_p[i] = reference_Nx[q_point][p_start + i];
+                N_J[i] = reference_Nx[q_point][J_start + i];
+            }
+        } else {
+            JxW = scratch.fe_values.JxW(q_point);
+            for (int i = 0; i < n_dofs_u; ++i) {
+                grad_Nx[i] =
+                    scratch.fe_values[u_fe].gradient(i, q_point) * F_inv;
+                symm_grad_Nx[i] = symmetrize(grad_Nx[i]);
+            }
+            for (int i = 0; i < n_dofs_pJ; ++i) {
+                N_p[i] = scratch.fe_values.shape_value(p_start + i, q_point);
+                N_J[i] = scratch.fe_values.shape_value(J_start + i, q_point);
+            }
+        }
+
+        for (int i = 0; i < n_dofs_u; ++i)
+            data.cell_rhs(i) -= (symm_grad_Nx[i] * tau) * JxW;
+        for (int i = 0; i < n_dofs_pJ; ++i) {
+            data.cell_rhs(p_start + i) -= N_p[i] * (det_F - J_tilde) * JxW;
+            data.cell_rhs(J_start + i) -=
+                N_J[i] * (dPsi_vol_dJ - p_tilde) * JxW;
+        }
+
+        if (!assembling_tangent)
+            continue;
+
+        for (int i = 0; i < n_dofs_u; ++i) // UU block
+        {
+            const unsigned int component_i = element_dof_components[i];
+            const SymmetricTensor<2, dim> symm_grad_Nx_i_x_Jc =
+                Jc.apply(symm_grad_Nx[i]);
+            const Tensor<1, dim> grad_Nx_i_comp_i_x_tau =
+                grad_Nx[i][component_i] * tau_ns;
+
+            for (int j = 0; j <= i; ++j) {
+                double k_ij = symm_grad_Nx_i_x_Jc * symm_grad_Nx[j];
+                if (component_i == element_dof_components[j])
+                    k_ij += grad_Nx_i_comp_i_x_tau * grad_Nx[j][component_i];
+                data.cell_matrix(i, j) += k_ij * JxW;
+            }
+        }
+
+        for (int i = 0; i < n_dofs_pJ; ++i) {
+            const double N_p_i_x_det_F_x_JxW = N_p[i] * det_F * JxW;
+            for (int j = 0; j < n_dofs_u; ++j) // PU block
+                k_pu[i * n_dofs_u + j] +=
+                    N_p_i_x_det_F_x_JxW * trace(symm_grad_Nx[j]);
+
+            for (int j = 0; j < n_dofs_pJ; ++j) {
+                k_Jp[i * n_dofs_pJ + j] -= N_J[i] * N_p[j] * JxW; // JP block
+                k_JJ[i * n_dofs_pJ + j] +=
+                    N_J[i] * d2Psi_vol_dJ2 * N_J[j] * JxW; // JJ block
+            }
+        }
+    }
+
+    for (int i = 0; i < n_dofs_pJ; ++i) {
+        for (int j = 0; j < n_dofs_u; ++j)
+            data.cell_matrix(p_start + i, j) = k_pu[i * n_dofs_u + j];
+        for (int j = 0; j < n_dofs_pJ; ++j)
+            data.cell_matrix(J_start + i, p_start + j) =
+                k_Jp[i * n_dofs_pJ + j];
+        for (int j = 0; j <= i; ++j)
+            data.cell_matrix(J_start + i, J_start + j) =
+                k_JJ[i * n_dofs_pJ + j];
+    }
+
+    assemble_traction_one_cell(cell, scratch, data);
+
+    for (const unsigned int i : scratch.fe_values.dof_indices())
+        for (const unsigned int j :
+             scratch.fe_values.dof_indices_starting_at(i + 1))
+            data.cell_matrix(i, j) = data.cell_matrix(j, i);
+}
+
+template <int dim>
+template <int fe_degree>
+typename Solid<dim>::AssemblyKernel
+Solid<dim>::get_fixed_assembly_kernel() const {
+    using Sizes = AssemblyKernelSizes<dim, fe_degree>;
+    return &Solid<dim>::template assemble_system_one_cell_fixed<
+        Sizes::n_dofs_u, Sizes::n_dofs_pJ, Sizes::n_q_points>;
+}
+
+template <int dim>
+typename Solid<dim>::AssemblyKernel Solid<dim>::select_assembly_kernel() const {
+    if (parameters.quad_order == degree + 1)
+        switch (degree) {
+        case 1:
+            return get_fixed_assembly_kernel<1>();
+        case 2:
+            return get_fixed_assembly_kernel<2>();
+        case 3:
+            return get_fixed_assembly_kernel<3>();
+        default:
+            break;
+        }
+
+    return &Solid<dim>::assemble_system_one_cell;
+}
+
+template <int dim>
+const std::vector<types::global_dof_index> &
+Solid<dim>::get_element_indices(const unsigned int block) const {
+    if (block == u_dof)
+        return element_indices_u;
+    else if (block == p_dof)
+        return element_indices_p;
+
+    Assert(block == J_dof, ExcIndexRange(block, 0, n_blocks));
+    return element_indices_J;
+}
+
+template <int dim>
+void Solid<dim>::apply_tangent_block(const unsigned int row_block,
+                                     const unsigned int col_block,
+                                     Vector<double> &dst,
+                                     const Vector<double> &src) const {
+    AssertDimension(dst.size(), dofs_per_block[row_block]);
+    AssertDimension(src.size(), dofs_per_block[col_block]);
+
+    const types::global_dof_index row_start =
+        system_rhs.get_block_indices().block_start(row_block);
+    const std::vector<types::global_dof_index> &row_indices =
+        get_element_indices(row_block);
+
+    const UpdateFlags uf_cell(update_values | update_gradients |
+                              update_JxW_values);
+    PerTaskData_MF per_task_data(dofs_per_cell);
+    ScratchData_MF scratch_data(fe, qf_cell, uf_cell,
+                                element_indices_p.size());
+
+    WorkStream::run(
+        dof_handler.active_cell_iterators(),
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            ScratchData_MF &scratch, PerTaskData_MF &data) {
+            this->apply_tangent_block_one_cell(cell, row_block, col_block,
+                                               src, scratch, data);
+        },
+        [&](const PerTaskData_MF &data) {
+            for (const auto i : row_indices) {
+                const types::global_dof_index dof = data.local_dof_indices[i];
+                if (row_block == u_dof && constraints.is_constrained(dof))
+                    continue;
+                dst(dof - row_start) += data.cell_dst(i);
+            }
+        },
+        scratch_data, per_task_data);
+
+    // Constrained displacement rows act like the scaled identity that
+    // distribute_local_to_global() would have put on the diagonal.
+    if (row_block == u_dof && col_block == u_dof)
+        for (types::global_dof_index dof = 0; dof < dofs_per_block[u_dof];
+             ++dof)
+            if (constraints.is_constrained(dof))
+                dst(dof) += constrained_diagonal_mf * src(dof);
+}
+
+// Fills the JxW values and, if requested, the pushed-forward displacement
+// gradients of a cell, taking the reference gradients from the shape cache
+// when it is enabled. p and J values come from reference_Nx.
+template <int dim>
+void Solid<dim>::reinit_mf_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const typename PointHistory<dim>::CellData &lqph,
+    const bool displacement_gradients, ScratchData_MF &scratch) const {
+    if (shape_cache.empty()) {
+        scratch.fe_values.reinit(cell);
+        for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+            scratch.JxW[q_point] = scratch.fe_values.JxW(q_point);
+            if (!displacement_gradients)
+                continue;
+            const Tensor<2, dim> F_inv = lqph.get_F_inv(q_point);
+            for (const auto k : element_indices_u)
+                scratch.grad_Nx[q_point][k] =
+                    scratch.fe_values[u_fe].gradient(k, q_point) * F_inv;
+        }
+        return;
+    }
+
+    for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+        scratch.JxW[q_point] = shape_cache.get_JxW(cell, q_point);
+        if (!displacement_gradients)
+            continue;
+        const Tensor<2, dim> F_inv = lqph.get_F_inv(q_point);
+        const Tensor<1, dim> *grad_phi =
+            shape_cache.get_gradients(cell, q_point);
+        for (unsigned int b = 0; b < scratch.grad_phi_x.size(); ++b)
+            scratch.grad_phi_x[b] = grad_phi[b] * F_inv;
+        for (const auto k : element_indices_u) {
+            Tensor<2, dim> &grad_Nx = scratch.grad_Nx[q_point][k];
+            grad_Nx = 0.0;
+            grad_Nx[element_dof_components[k]] =
+                scratch.grad_phi_x[element_dof_base_indices[k]];
+        }
+    }
+}
+
+template <int dim>
+void Solid<dim>::apply_tangent_block_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const unsigned int row_block, const unsigned int col_block,
+    const Vector<double> &src, ScratchData_MF &scratch,
+    PerTaskData_MF &data) const {
+    data.reset();
+    scratch.reset();
+    cell->get_dof_indices(data.local_dof_indices);
+
+    const typename PointHistory<dim>::CellData lqph =
+        quadrature_point_history.get_data(cell);
+    AssertDimension(lqph.size(), n_q_points);
+    reinit_mf_cell(cell, lqph, row_block == u_dof || col_block == u_dof,
+                   scratch);
+
+    const types::global_dof_index col_start =
+        system_rhs.get_block_indices().block_start(col_block);
+    const std::vector<types::global_dof_index> &row_indices =
+        get_element_indices(row_block);
+    const std::vector<types::global_dof_index> &col_indices =
+        get_element_indices(col_block);
+
+    for (const auto k : col_indices) {
+        const types::global_dof_index dof = data.local_dof_indices[k];
+        if (col_block == u_dof && constraints.is_constrained(dof))
+            continue;
+        scratch.cell_src[k] = src(dof - col_start);
+    }
+
+    for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+        const double JxW = scratch.JxW[q_point];
+        const ArrayView<const Tensor<2, dim>> grad_Nx =
+            make_array_view(scratch.grad_Nx, q_point);
+        const ArrayView<const double> N =
+            make_array_view(reference_Nx, q_point);
+
+        // Interpolate the source field at the quadrature point first, so
+        // that each block costs O(n_dofs) per quadrature point.
+        Tensor<2, dim> grad_src;
+        double N_src = 0.0;
+        if (col_block == u_dof)
+            for (const auto k : col_indices)
+                grad_src += scratch.cell_src[k] * grad_Nx[k];
+        else
+            for (const auto k : col_indices)
+                N_src += scratch.cell_src[k] * N[k];
+
+        if ((row_block == u_dof) && (col_block == u_dof)) // UU block
+        {
+            const SymmetricTensor<2, dim> Jc_x_symm_grad_src =
+                lqph.get_tangent(q_point).apply(symmetrize(grad_src));
+            const Tensor<2, dim> tau_ns = lqph.get_tau(q_point);
+            const Tensor<2, dim> grad_src_x_tau = grad_src * tau_ns;
+
+            for (const auto i : row_indices)
+                data.cell_dst(i) +=
+                    (symmetrize(grad_Nx[i]) * Jc_x_symm_grad_src +
+                     scalar_product(grad_Nx[i], grad_src_x_tau)) *
+                    JxW;
+        } else if ((row_block == p_dof) && (col_block == u_dof)) // PU block
+        {
+            const double det_F_x_div_src =
+                lqph.get_det_F(q_point) * trace(grad_src);
+            for (const auto i : row_indices)
+                data.cell_dst(i) += N[i] * det_F_x_div_src * JxW;
+        } else if ((row_block == u_dof) && (col_block == p_dof)) // UP block
+        {
+            const double det_F_x_N_src = lqph.get_det_F(q_point) * N_src;
+            for (const auto i : row_indices)
+                data.cell_dst(i) += trace(grad_Nx[i]) * det_F_x_N_src * JxW;
+        } else if (((row_block == J_dof) && (col_block == p_dof)) ||
+                   ((row_block == p_dof) && (col_block == J_dof))) // JP block
+        {
+            for (const auto i : row_indices)
+                data.cell_dst(i) -= N[i] * N_src * JxW;
+        } else if ((row_block == J_dof) && (col_block == J_dof)) // JJ block
+        {
+            const double d2Psi_vol_dJ2 = lqph.get_d2Psi_vol_dJ2(q_point);
+            for (const auto i : row_indices)
+                data.cell_dst(i) += N[i] * d2Psi_vol_dJ2 * N_src * JxW;
+        } else {
+            /* The UJ, JU and PP blocks vanish. */
+        }
+    }
+}
+
+// Adds K_uu_con src = (K_uu + K_up K_pp_bar K_pu) src to dst. Every Krylov
+// iteration of the condensed system is a single cell loop.
+template <int dim>
+void Solid<dim>::apply_condensed_tangent(Vector<double> &dst,
+                                         const Vector<double> &src) const {
+    AssertDimension(dst.size(), dofs_per_block[u_dof]);
+    AssertDimension(src.size(), dofs_per_block[u_dof]);
+    AssertDimension(K_pp_bar_mf.size(), triangulation.n_active_cells());
+
+    const UpdateFlags uf_cell(update_values | update_gradients |
+                              update_JxW_values);
+    PerTaskData_MF per_task_data(dofs_per_cell);
+    ScratchData_MF scratch_data(fe, qf_cell, uf_cell,
+                                element_indices_p.size());
+
+    WorkStream::run(
+        dof_handler.active_cell_iterators(),
+        [this, &src](const typename DoFHandler<dim>::active_cell_iterator &cell,
+                     ScratchData_MF &scratch, PerTaskData_MF &data) {
+            this->apply_condensed_tangent_one_cell(cell, src, scratch, data);
+        },
+        [this, &dst](const PerTaskData_MF &data) {
+            for (const auto i : element_indices_u) {
+                const types::global_dof_index dof = data.local_dof_indices[i];
+                if (!constraints.is_constrained(dof))
+                    dst(dof) += data.cell_dst(i);
+            }
+        },
+        scratch_data, per_task_data);
+
+    for (types::global_dof_index dof = 0; dof < dofs_per_block[u_dof]; ++dof)
+        if (constraints.is_constrained(dof))
+            dst(dof) += constrained_diagonal_mf * src(dof);
+}
+
+template <int dim>
+void Solid<dim>::apply_condensed_tangent_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    const Vector<double> &src, ScratchData_MF &scratch,
+    PerTaskData_MF &data) const {
+    data.reset();
+    scratch.reset();
+    cell->get_dof_indices(data.local_dof_indices);
+
+    const typename PointHistory<dim>::CellData lqph =
+        quadrature_point_history.get_data(cell);
+    AssertDimension(lqph.size(), n_q_points);
+    reinit_mf_cell(cell, lqph, true, scratch);
+
+    for (const auto k : element_indices_u) {
+        const types::global_dof_index dof = data.local_dof_indices[k];
+        if (!constraints.is_constrained(dof))
+            scratch.cell_src[k] = src(dof);
+    }
+
+    const unsigned int n_p = element_indices_p.size();
+
+    // b_p = K_pu src, keeping the source gradients for the second sweep
+    scratch.b_p = 0.0;
+    for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+        const ArrayView<const Tensor<2, dim>> grad_Nx =
+            make_array_view(scratch.grad_Nx, q_point);
+
+        Tensor<2, dim> grad_src;
+        for (const auto k : element_indices_u)
+            grad_src += scratch.cell_src[k] * grad_Nx[k];
+        scratch.grad_src[q_point] = grad_src;
+
+        const double det_F_x_div_src_x_JxW = lqph.get_det_F(q_point) *
+                                             trace(grad_src) *
+                                             scratch.JxW[q_point];
+        for (unsigned int i = 0; i < n_p; ++i)
+            scratch.b_p(i) += reference_Nx[q_point][element_indices_p[i]] *
+                              det_F_x_div_src_x_JxW;
+    }
+
+    K_pp_bar_mf[cell->active_cell_index()].vmult(scratch.c_p, scratch.b_p);
+
+    // dst = K_uu src + K_up c_p
+    for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+        const ArrayView<const Tensor<2, dim>> grad_Nx =
+            make_array_view(scratch.grad_Nx, q_point);
+        const Tensor<2, dim> &grad_src = scratch.grad_src[q_point];
+        const double JxW = scratch.JxW[q_point];
+
+        double N_c = 0.0;
+        for (unsigned int i = 0; i < n_p; ++i)
+            N_c += scratch.c_p(i) *
+                   reference_Nx[q_point][element_indices_p[i]];
+
+        const SymmetricTensor<2, dim> Jc_x_symm_grad_src =
+            lqph.get_tangent(q_point).apply(symmetrize(grad_src));
+        const Tensor<2, dim> tau_ns = lqph.get_tau(q_point);
+        const Tensor<2, dim> grad_src_x_tau = grad_src * tau_ns;
+        const double det_F_x_N_c = lqph.get_det_F(q_point) * N_c;
+
+        for (const auto i : element_indices_u)
+            data.cell_dst(i) += (symmetrize(grad_Nx[i]) * Jc_x_symm_grad_src +
+                                 scalar_product(grad_Nx[i], grad_src_x_tau) +
+                                 trace(grad_Nx[i]) * det_F_x_N_c) *
+                                JxW;
+    }
+}
+
+// Computes the diagonal of K_uu, used as the preconditioner of the
+// matrix-free solve, and the cell-wise K_pp_bar of the current tangent.
+template <int dim> void Solid<dim>::setup_tangent_mf() {
+    diagonal_K_uu_mf.reinit(dofs_per_block[u_dof]);
+
+    const unsigned int n_p = element_indices_p.size();
+    const unsigned int n_J = element_indices_J.size();
+    if (K_pp_bar_mf.size() != triangulation.n_active_cells())
+        K_pp_bar_mf.assign(triangulation.n_active_cells(),
+                           FullMatrix<double>(n_p, n_p));
+
+    const UpdateFlags uf_cell(update_values | update_gradients |
+                              update_JxW_values);
+    PerTaskData_MF per_task_data(dofs_per_cell);
+    ScratchData_MF scratch_data(fe, qf_cell, uf_cell, n_p);
+
+    WorkStream::run(
+        dof_handler.active_cell_iterators(),
+        [this, n_p,
+         n_J](const typename DoFHandler<dim>::active_cell_iterator &cell,
+              ScratchData_MF &scratch, PerTaskData_MF &data) {
+            data.reset();
+            cell->get_dof_indices(data.local_dof_indices);
+
+            const typename PointHistory<dim>::CellData lqph =
+                quadrature_point_history.get_data(cell);
+            AssertDimension(lqph.size(), n_q_points);
+            reinit_mf_cell(cell, lqph, true, scratch);
+
+            FullMatrix<double> k_Jp(n_J, n_p);
+            FullMatrix<double> k_JJ(n_J, n_J);
+            for (unsigned int q_point = 0; q_point < n_q_points; ++q_point) {
+                const ArrayView<const Tensor<2, dim>> grad_Nx =
+                    make_array_view(scratch.grad_Nx, q_point);
+                const ArrayView<const double> N =
+                    make_array_view(reference_Nx, q_point);
+                const SpatialTangent<dim> Jc = lqph.get_tangent(q_point);
+                const Tensor<2, dim> tau_ns = lqph.get_tau(q_point);
+                const double d2Psi_vol_dJ2 = lqph.get_d2Psi_vol_dJ2(q_point);
+                const double JxW = scratch.JxW[q_point];
+
+                for (const auto i : element_indices_u) {
+                    const SymmetricTensor<2, dim> symm_grad_Nx_i =
+                        symmetrize(grad_Nx[i]);
+                    data.cell_dst(i) +=
+                        (Jc.apply(symm_grad_Nx_i) * symm_grad_Nx_i +
+                         scalar_product(grad_Nx[i], grad_Nx[i] * tau_ns)) *
+                        JxW;
+                }
+
+                for (unsigned int i = 0; i < n_J; ++i) {
+                    const double N_i_x_JxW = N[element_indices_J[i]] * JxW;
+                    for (unsigned int j = 0; j < n_p; ++j)
+                        k_Jp(i, j) -= N_i_x_JxW * N[element_indices_p[j]];
+                    for (unsigned int j = 0; j < n_J; ++j)
+                        k_JJ(i, j) += N_i_x_JxW * d2Psi_vol_dJ2 *
+                                      N[element_indices_J[j]];
+                }
+            }
+
+            // K_pp_bar = k_Jp^-1 k_JJ k_Jp^-T; every cell writes its own
+            // matrix, so this needs no copier.
+            FullMatrix<double> k_Jp_inv(n_p, n_J);
+            FullMatrix<double> k_Jp_inv_x_k_JJ(n_p, n_J);
+            k_Jp_inv.invert(k_Jp);
+            k_Jp_inv.mmult(k_Jp_inv_x_k_JJ, k_JJ);
+            k_Jp_inv_x_k_JJ.mTmult(K_pp_bar_mf[cell->active_cell_index()],
+                                   k_Jp_inv);
+        },
+        [this](const PerTaskData_MF &data) {
+            for (const auto i : element_indices_u) {
+                const types::global_dof_index dof = data.local_dof_indices[i];
+                if (!constraints.is_constrained(dof))
+                    diagonal_K_uu_mf(dof) += data.cell_dst(i);
+            }
+        },
+        scratch_data, per_task_data);
+
+    double diagonal_sum = 0.0;
+    types::global_dof_index n_unconstrained = 0;
+    for (types::global_dof_index dof = 0; dof < dofs_per_block[u_dof]; ++dof)
+        if (!constraints.is_constrained(dof)) {
+            diagonal_sum += diagonal_K_uu_mf(dof);
+            ++n_unconstrained;
+        }
+    constrained_diagonal_mf =
+        (n_unconstrained > 0 ? diagonal_sum / n_unconstrained : 1.0);
+
+    for (types::global_dof_index dof = 0; dof < dofs_per_block[u_dof]; ++dof)
+        if (constraints.is_constrained(dof))
+            diagonal_K_uu_mf(dof) = constrained_diagonal_mf;
+}
+
+template <int dim> void Solid<dim>::make_constraints(const unsigned int it_nr) {
+    const bool apply_dirichlet_bc = (it_nr == 0);
+
+    if (it_nr > 1) {
+        std::cout << " --- " << std::flush;
+        return;
+    }
+
+    std::cout << " CST " << std::flush;
+
+    if (apply_dirichlet_bc) {
+        if (parameters.use_pipelining) {
+            // Built in the background by system_setup(); the constraints
+            // are homogeneous, so one copy serves every load step.
+            wait_for_constraints();
+            if (!dirichlet_constraints_ready) {
+                constraints.clear();
+                constraints.copy_from(dirichlet_constraints);
+                dirichlet_constraints_ready = true;
+            }
+            return;
+        }
+        make_dirichlet_constraints(constraints);
+    } else {
+        if (constraints.has_inhomogeneities()) {
+            AffineConstraints<double> homogeneous_constraints(constraints);
+            for (unsigned int dof = 0; dof != dof_handler.n_dofs(); ++dof)
+                if (homogeneous_constraints.is_inhomogeneously_constrained(dof))
+                    homogeneous_constraints.set_inhomogeneity(dof, 0.0);
+
+            constraints.clear();
+            constraints.copy_from(homogeneous_constraints);
+        }
+    }
+
+    constraints.close();
+}
+
+// Hanging node constraints plus the homogeneous Dirichlet conditions. Only
+// reads the DoFHandler, so it may run as a background task.
+template <int dim>
+void Solid<dim>::make_dirichlet_constraints(
+    AffineConstraints<double> &c) const {
+    c.clear();
+    DoFTools::make_hanging_node_constraints(dof_handler, c);
+
+    // Boundary 1 is clamped, boundaries 2 and 3 are fixed in z
+    const FEValuesExtractors::Scalar z_displacement(2);
+
+    {
+        const int boundary_id = 3;
+
+        VectorTools::interpolate_boundary_values(
+            dof_handler, boundary_id,
+            Functions::ZeroFunction<dim>(n_components), c,
+            fe.component_mask(z_displacement));
+    }
+    {
+        const int boundary_id = 1;
+
+        VectorTools::interpolate_boundary_values(
+            dof_handler, boundary_id,
+            Functions::ZeroFunction<dim>(n_components), c,
+            fe.component_mask(u_fe));
+    }
+
+    {
+        const int boundary_id = 2;
+
+        VectorTools::interpolate_boundary_values(
+            dof_handler, boundary_id,
+            Functions::ZeroFunction<dim>(n_components), c,
+            fe.component_mask(z_displacement));
+    }
+
+    c.close();
+}
+
+template <int dim> void Solid<dim>::wait_for_constraints() {
+    if (constraints_task.joinable())
+        constraints_task.join();
+    constraints_task = Threads::Task<void>();
+}
+
+// Eliminates the cell-local p and J dofs right after the cell matrix has been
+// built: the condensed contribution is added to the u-u block, the p and J
+// rows and columns are cleared so that only K_uu is scattered, and the
+// factors for the rhs reduction and recovery of p and J are kept per cell.
+template <int dim>
+void Solid<dim>::condense_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_ASM &scratch, PerTaskData_ASM &data) {
+    CondensedCellData &cell_data = condensed_cells[cell->active_cell_index()];
+    const unsigned int n_u = element_indices_u.size();
+
+    cell_data.k_pu.extract_submatrix_from(data.cell_matrix, element_indices_p,
+                                          element_indices_u);
+    scratch.k_pJ.extract_submatrix_from(data.cell_matrix, element_indices_p,
+                                        element_indices_J);
+    cell_data.k_JJ.extract_submatrix_from(data.cell_matrix, element_indices_J,
+                                          element_indices_J);
+
+    cell_data.k_pJ_inv.invert(scratch.k_pJ);
+
+    cell_data.k_pJ_inv.mmult(scratch.A, cell_data.k_pu);
+    cell_data.k_JJ.mmult(scratch.B, scratch.A);
+    cell_data.k_pJ_inv.Tmmult(scratch.C, scratch.B);
+    cell_data.k_pu.Tmmult(scratch.k_bbar, scratch.C);
+
+    for (unsigned int ii = 0; ii < n_u; ++ii)
+        for (unsigned int jj = 0; jj < n_u; ++jj)
+            data.cell_matrix(element_indices_u[ii], element_indices_u[jj]) +=
+                scratch.k_bbar(ii, jj);
+
+    // Local dofs are ordered u, p, J
+    for (unsigned int i = n_u; i < dofs_per_cell; ++i)
+        for (unsigned int j = 0; j < dofs_per_cell; ++j) {
+            data.cell_matrix(i, j) = 0.0;
+            data.cell_matrix(j, i) = 0.0;
+        }
+}
+
+// f_u -= K_up K_Jp^-1 (f_J - K_JJ K_pJ^-1 f_p), evaluated cell by cell from
+// the stored factors.
+template <int dim> void Solid<dim>::condense_rhs_fused() {
+    const unsigned int n_u = element_indices_u.size();
+    const unsigned int n_p = element_indices_p.size();
+    const unsigned int n_J = element_indices_J.size();
+
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    Vector<double> f_p(n_p), f_J(n_J), a_J(n_J), b_J(n_J), a_p(n_p), a_u(n_u);
+    Vector<double> cell_rhs(dofs_per_cell);
+
+    for (const auto &cell : dof_handler.active_cell_iterators()) {
+        const CondensedCellData &cell_data =
+            condensed_cells[cell->active_cell_index()];
+        cell->get_dof_indices(local_dof_indices);
+
+        for (unsigned int k = 0; k < n_p; ++k)
+            f_p(k) = system_rhs(local_dof_indices[element_indices_p[k]]);
+        for (unsigned int k = 0; k < n_J; ++k)
+            f_J(k) = system_rhs(local_dof_indices[element_indices_J[k]]);
+
+        cell_data.k_pJ_inv.vmult(a_J, f_p);
+        cell_data.k_JJ.vmult(b_J, a_J);
+        b_J.sadd(-1.0, f_J);
+        cell_data.k_pJ_inv.Tvmult(a_p, b_J);
+        cell_data.k_pu.Tvmult(a_u, a_p);
+
+        for (unsigned int k = 0; k < n_u; ++k)
+            cell_rhs(element_indices_u[k]) = -a_u(k);
+        constraints.distribute_local_to_global(cell_rhs, local_dof_indices,
+                                               system_rhs);
+    }
+}
+
+// Recovers the p and J updates cell by cell:
+//   dJ = K_pJ^-1 (f_p - K_pu du),  dp = K_Jp^-1 (f_J - K_JJ dJ).
+// The p and J dofs are discontinuous, so every cell writes its own entries
+// and the cells can be processed in parallel.
+template <int dim>
+void Solid<dim>::recover_pJ_fused(BlockVector<double> &newton_update) const {
+    PerTaskData_UQPH per_task_data;
+    ScratchData_PP scratch_data(dofs_per_cell, element_indices_u.size(),
+                                element_indices_p.size(),
+                                element_indices_J.size());
+
+    WorkStream::run(
+        dof_handler.active_cell_iterators(),
+        [this, &newton_update](
+            const typename DoFHandler<dim>::active_cell_iterator &cell,
+            ScratchData_PP &scratch, PerTaskData_UQPH &) {
+            this->recover_pJ_one_cell(cell, scratch, newton_update);
+        },
+        [](const PerTaskData_UQPH &) {}, scratch_data, per_task_data);
+}
+
+template <int dim>
+void Solid<dim>::recover_pJ_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_PP &scratch, BlockVector<double> &newton_update) const {
+    const unsigned int n_u = element_indices_u.size();
+    const unsigned int n_p = element_indices_p.size();
+    const unsigned int n_J = element_indices_J.size();
+    const CondensedCellData &cell_data =
+        condensed_cells[cell->active_cell_index()];
+    std::vector<types::global_dof_index> &local_dof_indices =
+        scratch.local_dof_indices;
+    cell->get_dof_indices(local_dof_indices);
+
+    for (unsigned int k = 0; k < n_u; ++k)
+        scratch.du(k) = newton_update(local_dof_indices[element_indices_u[k]]);
+    for (unsigned int k = 0; k < n_p; ++k)
+        scratch.f_p(k) = system_rhs(local_dof_indices[element_indices_p[k]]);
+    for (unsigned int k = 0; k < n_J; ++k)
+        scratch.f_J(k) = system_rhs(local_dof_indices[element_indices_J[k]]);
+
+    cell_data.k_pu.vmult(scratch.t_p, scratch.du);
+    scratch.t_p.sadd(-1.0, scratch.f_p);
+    cell_data.k_pJ_inv.vmult(scratch.dJ, scratch.t_p);
+
+    cell_data.k_JJ.vmult(scratch.t_J, scratch.dJ);
+    scratch.t_J.sadd(-1.0, scratch.f_J);
+    cell_data.k_pJ_inv.Tvmult(scratch.dp, scratch.t_J);
+
+    for (unsigned int k = 0; k < n_J; ++k)
+        newton_update(local_dof_indices[element_indices_J[k]]) =
+            scratch.dJ(k);
+    for (unsigned int k = 0; k < n_p; ++k)
+        newton_update(local_dof_indices[element_indices_p[k]]) =
+            scratch.dp(k);
+}
+
+template <int dim> void Solid<dim>::assemble_sc() {
+    timer.enter_subsection("Perform static condensation");
+    std::cout << " ASM_SC " << std::flush;
+
+    PerTaskData_SC per_task_data(dofs_per_cell);
+    ScratchData_SC scratch_data(dofs_per_cell, element_indices_u.size(),
+                                element_indices_p.size(),
+                                element_indices_J.size());
+
+    // Condensation only touches the cell's own rows, so the assembly colors
+    // let these copiers run concurrently as well.
+    if (parameters.use_colored_assembly) {
+        if (colored_cells.empty())
+            setup_cell_coloring();
+        WorkStream::run(
+            colored_cells,
+            [this](const typename DoFHandler<dim>::active_cell_iterator &cell,
+                   ScratchData_SC &scratch, PerTaskData_SC &data) {
+                this->assemble_sc_one_cell(cell, scratch, data);
+            },
+            [this](const PerTaskData_SC &data) {
+                this->copy_local_to_global_sc(data);
+            },
+            scratch_data, per_task_data);
+    } else
+        WorkStream::run(dof_handler.active_cell_iterators(), *this,
+                        &Solid::assemble_sc_one_cell,
+                        &Solid::copy_local_to_global_sc, scratch_data,
+                        per_task_data);
+
+    timer.leave_subsection();
+}
+
+template <int dim>
+void Solid<dim>::copy_local_to_global_sc(const PerTaskData_SC &data) {
+    // Row-wise insertion. Only the u-u and p-J blocks of the condensed cell
+    // matrix are populated; the zero entries elsewhere are skipped.
+    tangent_matrix.add(data.local_dof_indices, data.cell_matrix);
+}
+
+template <int dim>
+void Solid<dim>::assemble_sc_one_cell(
+    const typename DoFHandler<dim>::active_cell_iterator &cell,
+    ScratchData_SC &scratch, PerTaskData_SC &data) {
+    data.reset();
+    scratch.reset();
+    cell->get_dof_indices(data.local_dof_indices);
+
+    scratch.k_orig.extract_submatrix_from(
+        tangent_matrix, data.local_dof_indices, data.local_dof_indices);
+    scratch.k_pu.extract_submatrix_from(scratch.k_orig, element_indices_p,
+                                        element_indices_u);
+    scratch.k_pJ.extract_submatrix_from(scratch.k_orig, element_indices_p,
+                                        element_indices_J);
+    scratch.k_JJ.extract_submatrix_from(scratch.k_orig, element_indices_J,
+                                        element_indices_J);
+
+    scratch.k_pJ_inv.invert(scratch.k_pJ);
+
+    scratch.k_pJ_inv.mmult(scratch.A, scratch.k_pu);
+    scratch.k_JJ.mmult(scratch.B, scratch.A);
+    scratch.k_pJ_inv.Tmmult(scratch.C, scratch.B);
+    scratch.k_pu.Tmmult(scratch.k_bbar, scratch.C);
+    scratch.k_bbar.scatter_matrix_to(element_indices_u, element_indices_u,
+                                     data.cell_matrix);
+
+    scratch.k_pJ_inv.add(-1.0, scratch.k_pJ);
+    scratch.k_pJ_inv.scatter_matrix_to(element_indices_p, element_indices_J,
+                                       data.cell_matrix);
+}
+
+template <int dim>
+std::pair<unsigned int, double>
+Solid<dim>::solve_linear_system(BlockVector<double> &newton_update) {
+    unsigned int lin_it = 0;
+    double lin_res = 0.0;
+
+    if (parameters.use_static_condensation == true) {
+
+        BlockVector<double> &A = scratch_vectors.A;
+        BlockVector<double> &B = scratch_vectors.B;
+
+        {
+            if (use_fused_condensation()) {
+                // K_uu was already condensed during assembly
+                timer.enter_subsection("Perform static condensation");
+                std::cout << " ASM_SC " << std::flush;
+                condense_rhs_fused();
+                timer.leave_subsection();
+            } else {
+                // Condenses the tangent in place, so a kept tangent is
+                // already condensed
+                if (tangent_updated)
+                    assemble_sc();
+
+                tangent_matrix.block(p_dof, J_dof)
+                    .vmult(A.block(J_dof), system_rhs.block(p_dof));
+                tangent_matrix.block(J_dof, J_dof)
+                    .vmult(B.block(J_dof), A.block(J_dof));
+                A.block(J_dof) = system_rhs.block(J_dof);
+                A.block(J_dof) -= B.block(J_dof);
+                tangent_matrix.block(p_dof, J_dof)
+                    .Tvmult(A.block(p_dof), A.block(J_dof));
+                tangent_matrix.block(u_dof, p_dof)
+                    .vmult(A.block(u_dof), A.block(p_dof));
+                system_rhs.block(u_dof) -= A.block(u_dof);
+            }
+
+            timer.enter_subsection("Linear solver");
+            std::cout << " SLV " << std::flush;
+            if (parameters.type_lin == "CG") {
+                const auto solver_its = static_cast<unsigned int>(
+                    tangent_matrix.block(u_dof, u_dof).m() *
+                    parameters.max_iterations_lin);
+                const double tol_sol =
+                    parameters.tol_lin * system_rhs.block(u_dof).l2_norm();
+
+                if (parameters.mixed_precision == "solver") {
+                    std::tie(lin_it, lin_res) = solve_K_uu_mixed_precision(
+                        newton_update.block(u_dof), system_rhs.block(u_dof));
+                } else {
+                    SolverControl solver_control(solver_its, tol_sol);
+
+                    GrowingVectorMemory<Vector<double>> GVM;
+                    SolverCG<Vector<double>> solver_CG(solver_control, GVM);
+
+                    const auto preconditioner = setup_preconditioner_K_uu(
+                        tangent_matrix.block(u_dof, u_dof));
+
+                    solver_CG.solve(tangent_matrix.block(u_dof, u_dof),
+                                    newton_update.block(u_dof),
+                                    system_rhs.block(u_dof), preconditioner);
+
+                    lin_it = solver_control.last_step();
+                    lin_res = solver_control.last_value();
+                }
+                record_preconditioner_performance(lin_it);
+            } else if (parameters.type_lin == "Direct") {
+                update_direct_factorization(
+                    tangent_matrix.block(u_dof, u_dof));
+                direct_solver.vmult(newton_update.block(u_dof),
+                                    system_rhs.block(u_dof));
+
+                lin_it = 1;
+                lin_res = 0.0;
+            } else
+                Assert(false, ExcMessage("Linear solver type not implemented"));
+
+            timer.leave_subsection();
+        }
+
+        constraints.distribute(newton_update);
+
+        timer.enter_subsection("Linear solver postprocessing");
+        std::cout << " PP " << std::flush;
+
+        if (use_fused_condensation()) {
+            // With pipelining, the recovery is fused with the QPH update
+            if (!use_pipelined_recovery())
+                recover_pJ_fused(newton_update);
+        } else {
+            {
+                tangent_matrix.block(p_dof, u_dof)
+                    .vmult(A.block(p_dof), newton_update.block(u_dof));
+                A.block(p_dof) *= -1.0;
+                A.block(p_dof) += system_rhs.block(p_dof);
+                tangent_matrix.block(p_dof, J_dof)
+                    .vmult(newton_update.block(J_dof), A.block(p_dof));
+            }
+
+            constraints.distribute(newton_update);
+
+            {
+                tangent_matrix.block(J_dof, J_dof)
+                    .vmult(A.block(J_dof), newton_update.block(J_dof));
+                A.block(J_dof) *= -1.0;
+                A.block(J_dof) += system_rhs.block(J_dof);
+                tangent_matrix.block(p_dof, J_dof)
+                    .Tvmult(newton_update.block(p_dof), A.block(J_dof));
+            }
+        }
+
+        constraints.distribute(newton_update);
+
+        timer.leave_subsection();
+    } else {
+        std::cout << " ------ " << std::flush;
+
+        timer.enter_subsection("Linear solver");
+        std::cout << " SLV " << std::flush;
+
+        if (parameters.type_lin == "CG") {
+
+            const Vector<double> &f_u = system_rhs.block(u_dof);
+            const Vector<double> &f_p = system_rhs.block(p_dof);
+            const Vector<double> &f_J = system_rhs.block(J_dof);
+
+            Vector<double> &d_u = newton_update.block(u_dof);
+            Vector<double> &d_p = newton_update.block(p_dof);
+            Vector<double> &d_J = newton_update.block(J_dof);
+
+            if (parameters.use_matrix_free)
+                setup_tangent_mf();
+
+            const TangentBlockOperator K_uu_mf(*this, u_dof, u_dof);
+            const TangentBlockOperator K_up_mf(*this, u_dof, p_dof);
+            const TangentBlockOperator K_pu_mf(*this, p_dof, u_dof);
+            const TangentBlockOperator K_JJ_mf(*this, J_dof, J_dof);
+
+            const auto K_uu =
+                parameters.use_matrix_free
+                    ? linear_operator(K_uu_mf)
+                    : linear_operator(tangent_matrix.block(u_dof, u_dof));
+            const auto K_up =
+                parameters.use_matrix_free
+                    ? linear_operator(K_up_mf)
+                    : linear_operator(tangent_matrix.block(u_dof, p_dof));
+            const auto K_pu =
+                parameters.use_matrix_free
+                    ? linear_operator(K_pu_mf)
+                    : linear_operator(tangent_matrix.block(p_dof, u_dof));
+            const auto K_JJ =
+                parameters.use_matrix_free
+                    ? linear_operator(K_JJ_mf)
+                    : linear_operator(tangent_matrix.block(J_dof, J_dof));
+
+            // p and J are discontinuous, so K_Jp is inverted exactly cell
+            // by cell instead of with a nested CG solve.
+            if (K_Jp_inverse.empty())
+                setup_K_Jp_inverse();
+            const auto K_Jp_inv = linear_operator(K_Jp_inverse);
+
+            const auto K_pJ_inv = transpose_operator(K_Jp_inv);
+            const auto K_pp_bar = K_Jp_inv * K_JJ * K_pJ_inv;
+            const auto K_uu_bar_bar = K_up * K_pp_bar * K_pu;
+
+            // Matrix-free, the condensed operator is applied in one cell
+            // loop instead of one loop per block.
+            const CondensedTangentOperator K_uu_con_mf(*this);
+            const auto K_uu_con = parameters.use_matrix_free
+                                      ? linear_operator(K_uu_con_mf)
+                                      : K_uu + K_uu_bar_bar;
+
+            DiagonalMatrix<Vector<double>> preconditioner_K_con_inv_mf;
+            if (parameters.use_matrix_free) {
+                Vector<double> inverse_diagonal(diagonal_K_uu_mf);
+                for (auto &entry : inverse_diagonal)
+                    entry = 1.0 / entry;
+                preconditioner_K_con_inv_mf.reinit(inverse_diagonal);
+            }
+            const auto P_K_con_inv =
+                parameters.use_matrix_free
+                    ? linear_operator(K_uu_mf, preconditioner_K_con_inv_mf)
+                    : setup_preconditioner_K_uu(
+                          tangent_matrix.block(u_dof, u_dof));
+            ReductionControl solver_control_K_con_inv(
+                static_cast<unsigned int>(dofs_per_block[u_dof] *
+                                          parameters.max_iterations_lin),
+                1.0e-30, parameters.tol_lin);
+            SolverSelector<Vector<double>> solver_K_con_inv;
+            solver_K_con_inv.select("cg");
+            solver_K_con_inv.set_control(solver_control_K_con_inv);
+            const auto K_uu_con_inv =
+                inverse_operator(K_uu_con, solver_K_con_inv, P_K_con_inv);
+
+            d_u =
+                K_uu_con_inv * (f_u - K_up * (K_Jp_inv * f_J - K_pp_bar * f_p));
+
+            timer.leave_subsection();
+
+            timer.enter_subsection("Linear solver postprocessing");
+            std::cout << " PP " << std::flush;
+
+            d_J = K_pJ_inv * (f_p - K_pu * d_u);
+            d_p = K_Jp_inv * (f_J - K_JJ * d_J);
+
+            lin_it = solver_control_K_con_inv.last_step();
+            lin_res = solver_control_K_con_inv.last_value();
+            record_preconditioner_performance(lin_it);
+        } else if (parameters.type_lin == "Direct") {
+            update_direct_factorization(tangent_matrix);
+            direct_solver.vmult(newton_update, system_rhs);
+
+            lin_it = 1;
+            lin_res = 0.0;
+
+            std::cout << " -- " << std::flush;
+        } else
+            Assert(false, ExcMessage("Linear solver type not implemented"));
+
+        timer.leave_subsection();
+
+        constraints.distribute(newton_update);
+    }
+
+    tangent_updated = false;
+    return std::make_pair(lin_it, lin_res);
+}
+
+template <int dim>
+template <typename MatrixType>
+void Solid<dim>::update_direct_factorization(const MatrixType &matrix) {
+    // Modified Newton: an older factorization stays in use for a limited
+    // number of iterations, as long as the residual keeps decreasing. A
+    // tangent that was not reassembled keeps its factorization.
+    const bool reuse_factorization =
+        direct_solver.is_factorized() &&
+        (!tangent_updated ||
+         (factorization_age < parameters.max_factorization_reuse &&
+          error_residual.norm < residual_at_last_solve));
+    residual_at_last_solve = error_residual.norm;
+
+    if (reuse_factorization) {
+        ++factorization_age;
+        return;
+    }
+
+    direct_solver.factorize(matrix);
+    factorization_age = 0;
+}
+
+template <int dim>
+LinearOperator<Vector<double>>
+Solid<dim>::setup_preconditioner_K_uu(const SparseMatrix<double> &K_uu) {
+#ifdef DEAL_II_WITH_TRILINOS
+    if (parameters.preconditioner_type == "amg") {
+        // The hierarchy is only rebuilt once the iteration counts show that
+        // it no longer matches the current tangent.
+        if (!preconditioner_amg_K_uu || amg_rebuild_requested) {
+            TrilinosWrappers::PreconditionAMG::AdditionalData amg_data;
+            amg_data.elliptic = true;
+            amg_data.higher_order_elements = (degree > 1);
+            amg_data.smoother_sweeps = 2;
+            amg_data.aggregation_threshold = 0.02;
+            amg_data.constant_modes_values = compute_rigid_body_modes();
+
+            preconditioner_amg_K_uu =
+                std::make_unique<TrilinosWrappers::PreconditionAMG>();
+            preconditioner_amg_K_uu->initialize(K_uu, amg_data);
+
+            amg_rebuild_requested = false;
+            amg_reference_iterations = 0;
+        }
+
+        return linear_operator(K_uu, *preconditioner_amg_K_uu);
+    }
+#endif
+
+    if (parameters.preconditioner_type == "gmg") {
+        // The level operators only depend on the mesh, so the hierarchy is
+        // built once per call to system_setup().
+        if (!multigrid_K_uu) {
+            Timer mg_timer;
+            const double kappa =
+                (2.0 * parameters.mu * (1.0 + parameters.nu)) /
+                (3.0 * (1.0 - 2.0 * parameters.nu));
+            multigrid_K_uu =
+                std::make_unique<DisplacementMultigrid<dim>>(degree);
+            multigrid_K_uu->initialize(dof_handler, qf_cell, parameters.mu,
+                                       kappa, parameters.chebyshev_degree);
+            mg_timer.stop();
+            std::cout << "    Multigrid hierarchy: "
+                      << multigrid_K_uu->n_levels() << " levels, built in "
+                      << mg_timer.wall_time() << " s" << std::endl;
+        }
+
+        return linear_operator(K_uu, *multigrid_K_uu);
+    }
+
+    if (parameters.mixed_precision != "off") {
+        setup_preconditioner_K_uu_float(K_uu);
+        return linear_operator(K_uu, *preconditioner_K_uu_float);
+    }
+
+    preconditioner_selector_K_uu = std::make_unique<
+        PreconditionSelector<SparseMatrix<double>, Vector<double>>>(
+        parameters.preconditioner_type, parameters.preconditioner_relaxation);
+    preconditioner_selector_K_uu->use_matrix(K_uu);
+
+    return linear_operator(K_uu, *preconditioner_selector_K_uu);
+}
+
+// K_Jp = -(N_J, N_p) on the reference cell; it couples only the p and J dofs
+// of one cell and does not change with the deformation.
+template <int dim> void Solid<dim>::setup_K_Jp_inverse() {
+    const unsigned int n_p = element_indices_p.size();
+    const unsigned int n_J = element_indices_J.size();
+    const types::global_dof_index p_start =
+        system_rhs.get_block_indices().block_start(p_dof);
+    const types::global_dof_index J_start =
+        system_rhs.get_block_indices().block_start(J_dof);
+
+    K_Jp_inverse.reinit(triangulation.n_active_cells(), n_p,
+                        dofs_per_block[J_dof], dofs_per_block[p_dof]);
+
+    FEValues<dim> fe_values(fe, qf_cell, update_values | update_JxW_values);
+    FullMatrix<double> k_Jp(n_J, n_p);
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    std::vector<types::global_dof_index> rows(n_J);
+    std::vector<types::global_dof_index> cols(n_p);
+
+    for (const auto &cell : dof_handler.active_cell_iterators()) {
+        fe_values.reinit(cell);
+        cell->get_dof_indices(local_dof_indices);
+
+        k_Jp = 0.0;
+        for (const unsigned int q_point : fe_values.quadrature_point_indices())
+            for (unsigned int i = 0; i < n_J; ++i)
+                for (unsigned int j = 0; j < n_p; ++j)
+                    k_Jp(i, j) -=
+                        fe_values[J_fe].value(element_indices_J[i], q_point) *
+                        fe_values[p_fe].value(element_indices_p[j], q_point) *
+                        fe_values.JxW(q_point);
+
+        for (unsigned int i = 0; i < n_J; ++i)
+            rows[i] = local_dof_indices[element_indices_J[i]] - J_start;
+        for (unsigned int j = 0; j < n_p; ++j)
+            cols[j] = local_dof_indices[element_indices_p[j]] - p_start;
+
+        K_Jp_inverse.set_cell(cell->active_cell_index(), k_Jp, rows, cols);
+    }
+}
+
+// Jacobi and SSOR sweep through the whole matrix on every application; on
+// the float copy they move roughly two thirds of the bytes.
+template <int dim>
+void Solid<dim>::setup_preconditioner_K_uu_float(
+    const SparseMatrix<double> &K_uu) {
+    K_uu_float.copy_from(K_uu);
+
+    if (!preconditioner_K_uu_float) {
+        preconditioner_selector_K_uu_float = std::make_unique<
+            PreconditionSelector<SparseMatrix<float>, Vector<float>>>(
+            parameters.preconditioner_type,
+            parameters.preconditioner_relaxation);
+        preconditioner_selector_K_uu_float->use_matrix(K_uu_float);
+        preconditioner_K_uu_float = std::make_unique<
+            SinglePrecisionPreconditioner<PreconditionSelector<
+                SparseMatrix<float>, Vector<float>>>>(
+            *preconditioner_selector_K_uu_float);
+    }
+}
+
+// Defect correction: the Krylov solve runs on the float copy of K_uu, and
+// the residual is recomputed in double precision until it meets tol_lin.
+// Single precision cannot reduce the residual much further than 1e-4, so
+// each inner solve only aims for that and the outer loop recovers the
+// remaining digits.
+template <int dim>
+std::pair<unsigned int, double>
+Solid<dim>::solve_K_uu_mixed_precision(Vector<double> &d_u,
+                                       const Vector<double> &f_u) {
+    const SparseMatrix<double> &K_uu = tangent_matrix.block(u_dof, u_dof);
+    setup_preconditioner_K_uu_float(K_uu);
+
+    const auto max_its =
+        static_cast<unsigned int>(K_uu.m() * parameters.max_iterations_lin);
+    const double tol_sol = parameters.tol_lin * f_u.l2_norm();
+
+    Vector<double> r(f_u.size());
+    Vector<double> correction(f_u.size());
+    Vector<float> r_float(f_u.size());
+    Vector<float> correction_float(f_u.size());
+
+    GrowingVectorMemory<Vector<float>> GVM;
+
+    unsigned int n_its = 0;
+    double res = K_uu.residual(r, d_u, f_u);
+    while (res > tol_sol) {
+        r_float = r;
+        correction_float = 0.0f;
+
+        ReductionControl solver_control(max_its - n_its, 0.0, 1.0e-4, false,
+                                        false);
+        SolverCG<Vector<float>> solver_CG(solver_control, GVM);
+        try {
+            solver_CG.solve(K_uu_float, correction_float, r_float,
+                            *preconditioner_selector_K_uu_float);
+        } catch (const SolverControl::NoConvergence &) {
+            // Stagnation in single precision; the outer residual decides
+        }
+        n_its += solver_control.last_step();
+
+        correction = correction_float;
+        d_u += correction;
+
+        const double res_old = res;
+        res = K_uu.residual(r, d_u, f_u);
+
+        if (res > tol_sol && (n_its >= max_its || res >= res_old))
+            throw SolverControl::NoConvergence(n_its, res);
+    }
+
+    return std::make_pair(n_its, res);
+}
+
+template <int dim>
+void Solid<dim>::record_preconditioner_performance(const unsigned int lin_it) {
+    if (parameters.preconditioner_type != "amg")
+        return;
+
+    if (amg_reference_iterations == 0)
+        amg_reference_iterations = std::max(lin_it, 1U);
+    else if (lin_it > parameters.amg_rebuild_ratio * amg_reference_iterations)
+        amg_rebuild_requested = true;
+}
+
+template <int dim>
+std::vector<std::vector<double>> Solid<dim>::compute_rigid_body_modes() const {
+    const unsigned int n_rotations = (dim == 3 ? 3 : 1);
+    std::vector<std::vector<double>> modes(
+        dim + n_rotations, std::vector<double>(dofs_per_block[u_dof], 0.0));
+
+    // Evaluate the modes at the support points of the displacement base
+    // element, which is the interpolation onto FE_Q.
+    const Quadrature<dim> support_quadrature(
+        fe.base_element(0).get_unit_support_points());
+    FEValues<dim> fe_values(fe, support_quadrature, update_quadrature_points);
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+    for (const auto &cell : dof_handler.active_cell_iterators()) {
+        fe_values.reinit(cell);
+        cell->get_dof_indices(local_dof_indices);
+
+        for (const auto k : element_indices_u) {
+            const unsigned int component = element_dof_components[k];
+            const Point<dim> &X =
+                fe_values.quadrature_point(fe.system_to_base_index(k).second);
+            const types::global_dof_index dof = local_dof_indices[k];
+
+            modes[component][dof] = 1.0;
+            if (dim == 2) {
+                modes[dim][dof] = (component == 0 ? -X[1] : X[0]);
+            } else {
+                const unsigned int c = component;
+                modes[dim][dof] = (c == 0 ? -X[1] : (c == 1 ? X[0] : 0.0));
+                modes[dim + 1][dof] =
+                    (c == 1 ? -X[dim - 1] : (c == 2 ? X[1] : 0.0));
+                modes[dim + 2][dof] =
+                    (c == 2 ? -X[0] : (c == 0 ? X[dim - 1] : 0.0));
+            }
+        }
+    }
+
+    return modes;
+}
+
+// Snapshots the solution and, if selected, the cell-averaged stress norm on
+// the solver thread; the patches are built and written by output_task,
+// optionally in the background while the next timestep is solved.
+template <int dim>
+void Solid<dim>::output_results(const unsigned int timestep) {
+    // Only the time the Newton loop spends here, including the wait for
+    // the previous output, is recorded; the rest overlaps with the solve.
+    timer.enter_subsection("Output");
+    wait_for_output();
+
+    const bool write_displacement = output_field("displacement");
+    const bool write_pressure = output_field("pressure");
+    const bool write_dilatation = output_field("dilatation");
+    const bool write_stress_norm = output_field("stress norm");
+
+    Vector<double> stress_norm;
+    if (write_stress_norm) {
+        stress_norm.reinit(triangulation.n_active_cells());
+        unsigned int counter = 0;
+        for (const auto &cell : triangulation.active_cell_iterators()) {
+            double accumulated_norm = 0.0;
+            const typename PointHistory<dim>::CellData lqph =
+                quadrature_point_history.get_data(cell);
+            for (unsigned int q = 0; q < n_q_points; ++q)
+                accumulated_norm += lqph.get_tau(q).norm();
+
+            stress_norm[counter++] = accumulated_norm / n_q_points;
+        }
+    }
+
+    // The probes report the tip position, if there are any
+    const bool report_highest_point =
+        parameters.probe_points.empty() && parameters.probe_lines.empty();
+
+    // The background task needs its own copy of the solution
+    Vector<double> soln(solution_n.begin(), solution_n.end());
+
+    const unsigned int n_subdivisions = parameters.patch_subdivisions > 0
+                                            ? parameters.patch_subdivisions
+                                            : degree;
+    const std::string filename = output_prefix + "solution-" +
+                                 std::to_string(dim) + "d-" +
+                                 std::to_string(timestep) + ".vtu";
+
+    DataOutBase::CompressionLevel compression_level =
+        DataOutBase::CompressionLevel::best_speed;
+    if (parameters.compression_level == "none")
+        compression_level = DataOutBase::CompressionLevel::no_compression;
+    else if (parameters.compression_level == "default")
+        compression_level = DataOutBase::CompressionLevel::default_compression;
+    else if (parameters.compression_level == "best compression")
+        compression_level = DataOutBase::CompressionLevel::best_compression;
+
+    const auto write_output = [this, soln = std::move(soln),
+                               stress_norm = std::move(stress_norm),
+                               n_subdivisions, filename, compression_level,
+                               write_displacement, write_pressure,
+                               write_dilatation, write_stress_norm,
+                               report_highest_point]() -> std::string {
+        DataOut<dim> data_out;
+
+        DataOutBase::VtkFlags output_flags;
+        output_flags.write_higher_order_cells = true;
+        output_flags.physical_units["displacement"] = "m";
+        output_flags.compression_level = compression_level;
+        data_out.set_flags(output_flags);
+
+        data_out.attach_dof_handler(dof_handler);
+
+        // A partial selection of the solution fields goes through a
+        // postprocessor, which has to live until the patches are built
+        const SolutionFieldSelector<dim> field_selector(
+            write_displacement, write_pressure, write_dilatation);
+        if (write_displacement && write_pressure && write_dilatation) {
+            std::vector<
+                DataComponentInterpretation::DataComponentInterpretation>
+                data_component_interpretation(
+                    dim,
+                    DataComponentInterpretation::component_is_part_of_vector);
+            data_component_interpretation.push_back(
+                DataComponentInterpretation::component_is_scalar);
+            data_component_interpretation.push_back(
+                DataComponentInterpretation::component_is_scalar);
+
+            std::vector<std::string> solution_name(dim, "displacement");
+            solution_name.emplace_back("pressure");
+            solution_name.emplace_back("dilatation");
+
+            data_out.add_data_vector(soln, solution_name,
+                                     DataOut<dim>::type_dof_data,
+                                     data_component_interpretation);
+        } else if (write_displacement || write_pressure || write_dilatation)
+            data_out.add_data_vector(soln, field_selector);
+        if (write_stress_norm)
+            data_out.add_data_vector(stress_norm, "stress_norm");
+
+        const MappingQEulerian<dim> q_mapping(degree, dof_handler, soln);
+        data_out.build_patches(q_mapping, n_subdivisions);
+
+        std::ostringstream report;
+        if (report_highest_point) {
+            double max_y = -std::numeric_limits<double>::max();
+            Point<dim> max_point;
+            for (const auto &patch : data_out.get_patches()) {
+                for (const auto &vertex : patch.vertices) {
+                    if (vertex[1] > max_y) {
+                        max_y = vertex[1];
+                        max_point = vertex;
+                    }
+                }
+            }
+
+            report << std::fixed << std::setprecision(6);
+            report << "Heightest position when deformed state: " << max_point
+                   << std::endl;
+        }
+
+        std::ofstream output(filename);
+        data_out.write_vtu(output);
+
+        return report.str();
+    };
+
+    output_task = Threads::new_task(write_output);
+    if (!parameters.use_async_output)
+        wait_for_output();
+
+    timer.leave_subsection();
+}
+
+template <int dim>
+bool Solid<dim>::output_field(const std::string &name) const {
+    return std::find(parameters.output_fields.begin(),
+                     parameters.output_fields.end(),
+                     name) != parameters.output_fields.end();
+}
+
+// Joins the pending output task, if any, and prints its report.
+template <int dim> void Solid<dim>::wait_for_output() {
+    if (!output_task.joinable())
+        return;
+
+    std::cout << std::fixed << std::setprecision(6)
+              << output_task.return_value() << std::flush;
+    output_task = Threads::Task<std::string>();
+}
+
+// Parses the probe points and samples the probe lines of the parameter file.
+template <int dim>
+std::vector<Point<dim>> Solid<dim>::get_probe_points() const {
+    const auto parse_point = [](const std::string &text) {
+        const std::vector<std::string> coordinates =
+            Utilities::split_string_list(text, ',');
+        AssertThrow(coordinates.size() == dim,
+                    ExcMessage("The probe point <" + text + "> needs " +
+                               std::to_string(dim) + " coordinates."));
+        Point<dim> point;
+        for (unsigned int d = 0; d < dim; ++d)
+            point[d] = Utilities::string_to_double(coordinates[d]);
+        return point;
+    };
+
+    std::vector<Point<dim>> points;
+    for (const auto &entry :
+         Utilities::split_string_list(parameters.probe_points, ';'))
+        points.push_back(parse_point(entry));
+
+    for (const auto &entry :
+         Utilities::split_string_list(parameters.probe_lines, ';')) {
+        const std::vector<std::string> fields =
+            Utilities::split_string_list(entry, ':');
+        AssertThrow(fields.size() == 3,
+                    ExcMessage("The probe line <" + entry +
+                               "> is not of the form start : end : n."));
+        const Point<dim> start = parse_point(fields[0]);
+        const Point<dim> end = parse_point(fields[1]);
+        const int n_points = Utilities::string_to_int(fields[2]);
+        AssertThrow(n_points >= 2,
+                    ExcMessage("The probe line <" + entry +
+                               "> needs at least 2 points."));
+        for (int k = 0; k < n_points; ++k)
+            points.push_back(start +
+                             (end - start) * (1.0 * k / (n_points - 1)));
+    }
+
+    return points;
+}
+
+// Finds the cell of the undeformed mesh around every probe point once, so
+// that a probe costs a single dot product per timestep.
+template <int dim> void Solid<dim>::locate_probes() {
+    probes.clear();
+    const unsigned int n_reported =
+        Utilities::split_string_list(parameters.probe_points, ';').size();
+
+    const MappingQ<dim> mapping(1);
+    for (const Point<dim> &point : get_probe_points()) {
+        std::pair<typename DoFHandler<dim>::active_cell_iterator, Point<dim>>
+            cell_and_point;
+        try {
+            cell_and_point = GridTools::find_active_cell_around_point(
+                mapping, dof_handler, point);
+        } catch (const GridTools::ExcPointNotFound<dim> &) {
+            // Reported below together with an invalid iterator
+        }
+        std::ostringstream point_text;
+        point_text << point;
+        AssertThrow(cell_and_point.first.state() == IteratorState::valid,
+                    ExcMessage("The probe point " + point_text.str() +
+                               " lies outside the mesh."));
+
+        Probe probe;
+        probe.point = point;
+        probe.report = probes.size() < n_reported;
+        probe.dof_indices.resize(dofs_per_cell);
+        cell_and_point.first->get_dof_indices(probe.dof_indices);
+        probe.shape_values.resize(dofs_per_cell);
+        for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            probe.shape_values[k] = fe.shape_value(k, cell_and_point.second);
+        probes.push_back(std::move(probe));
+    }
+}
+
+// Evaluates displacement, pressure and dilatation of solution_n at the
+// probes and appends them to the probe file; the probe points are printed.
+template <int dim>
+void Solid<dim>::write_probes(const unsigned int timestep) {
+    if (parameters.probe_points.empty() && parameters.probe_lines.empty())
+        return;
+    if (probes.empty())
+        locate_probes();
+
+    const std::string filename = output_prefix + parameters.probe_file;
+    if (filename != probe_filename) {
+        if (probe_output.is_open())
+            probe_output.close();
+        probe_output.open(filename, parameters.restart
+                                        ? std::ios::out | std::ios::app
+                                        : std::ios::out | std::ios::trunc);
+        AssertThrow(probe_output,
+                    ExcMessage("Cannot open the probe file <" + filename +
+                               ">."));
+        probe_filename = filename;
+
+        if (!parameters.restart) {
+            probe_output << "timestep,time,probe";
+            for (unsigned int d = 0; d < dim; ++d)
+                probe_output << ',' << "xyz"[d];
+            for (unsigned int d = 0; d < dim; ++d)
+                probe_output << ",u_" << "xyz"[d];
+            probe_output << ",p,J\n";
+        }
+    }
+
+    probe_output << std::setprecision(10);
+    Vector<double> values(n_components);
+    for (unsigned int k = 0; k < probes.size(); ++k) {
+        const Probe &probe = probes[k];
+        values = 0.0;
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+            values(fe.system_to_component_index(i).first) +=
+                solution_n(probe.dof_indices[i]) * probe.shape_values[i];
+
+        probe_output << timestep << ',' << time.current() << ',' << k;
+        for (unsigned int d = 0; d < dim; ++d)
+            probe_output << ',' << probe.point[d];
+        for (unsigned int c = 0; c < n_components; ++c)
+            probe_output << ',' << values(c);
+        probe_output << '\n';
+
+        if (probe.report) {
+            Tensor<1, dim> u;
+            for (unsigned int d = 0; d < dim; ++d)
+                u[d] = values(d);
+            std::cout << std::fixed << std::setprecision(6) << "Probe " << k
+                      << " at " << probe.point << ": u = " << u
+                      << ", p = " << values(p_component)
+                      << ", J = " << values(J_component) << std::endl;
+        }
+    }
+    probe_output << std::flush;
+}
+
+// Identifies the layout of the checkpoint archive
+static const unsigned int checkpoint_format_version = 3;
+
+// Checkpoints the mesh, solution_n, the time state and the quadrature point
+// history after a converged timestep. The dof numbering is reproduced by
+// system_setup() on restart and verified against the stored dof count. The
+// archive is written to a temporary file first so that a crash while writing
+// leaves the previous checkpoint intact.
+template <int dim> void Solid<dim>::save_checkpoint() const {
+    timer.enter_subsection("Checkpoint");
+    std::cout << "    Writing checkpoint " << parameters.checkpoint_file
+              << std::endl;
+
+    const std::string tmp_file = parameters.checkpoint_file + ".tmp";
+    {
+        std::ofstream out(tmp_file, std::ios::binary);
+        AssertThrow(out, ExcMessage("Cannot open " + tmp_file));
+        boost::archive::binary_oarchive ar(out);
+
+        const unsigned int format_version = checkpoint_format_version;
+        const unsigned int dimension = dim;
+        ar << format_version << dimension << parameters.poly_degree
+           << parameters.quad_order << parameters.tangent_form;
+
+        ar << triangulation;
+
+        const types::global_dof_index n_dofs = dof_handler.n_dofs();
+        ar << n_dofs;
+        for (unsigned int b = 0; b < solution_n.n_blocks(); ++b)
+            ar << solution_n.block(b);
+
+        ar << time;
+        ar << quadrature_point_history;
+    }
+    AssertThrow(std::rename(tmp_file.c_str(),
+                            parameters.checkpoint_file.c_str()) == 0,
+                ExcMessage("Cannot move " + tmp_file + " to " +
+                           parameters.checkpoint_file));
+
+    timer.leave_subsection();
+}
+
+// Restores the state written by save_checkpoint() in place of the mesh
+// generation and the initial projection of J.
+template <int dim> void Solid<dim>::load_checkpoint() {
+    std::cout << "Restarting from " << parameters.checkpoint_file << std::endl;
+
+    std::ifstream in(parameters.checkpoint_file, std::ios::binary);
+    AssertThrow(in, ExcMessage("Cannot open " + parameters.checkpoint_file));
+    boost::archive::binary_iarchive ar(in);
+
+    unsigned int format_version, dimension, poly_degree, quad_order;
+    std::string tangent_form;
+    ar >> format_version >> dimension >> poly_degree >> quad_order >>
+        tangent_form;
+    AssertThrow(format_version == checkpoint_format_version && dimension == dim,
+                ExcMessage("Incompatible checkpoint file."));
+    AssertThrow(poly_degree == parameters.poly_degree &&
+                    quad_order == parameters.quad_order &&
+                    tangent_form == parameters.tangent_form,
+                ExcMessage("The checkpoint was written with a different "
+                           "finite element, quadrature or tangent form."));
+
+    multigrid_K_uu.reset();
+    wait_for_constraints();
+    dof_handler.clear();
+    ar >> triangulation;
+
+    vol_reference = GridTools::volume(triangulation);
+    std::cout << "Grid:\n\t Reference volume: " << vol_reference << std::endl;
+
+    system_setup();
+
+    types::global_dof_index n_dofs;
+    ar >> n_dofs;
+    AssertThrow(n_dofs == dof_handler.n_dofs(),
+                ExcMessage("The checkpoint does not match the dof numbering."));
+    for (unsigned int b = 0; b < solution_n.n_blocks(); ++b)
+        ar >> solution_n.block(b);
+
+    ar >> time;
+    ar >> quadrature_point_history;
+
+    std::cout << "    Resuming at timestep " << time.get_timestep() << " @ "
+              << time.current() << 's' << std::endl;
+}
+
+} // namespace MLSolver
+
+#endif /* Solid_h */
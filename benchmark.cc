@@ -0,0 +1,284 @@
+/*
+ * Benchmark driver for Solid<dim>: runs the Cook's membrane problem over a
+ * sweep of cell counts, polynomial degrees, thread counts and linear solver
+ * configurations and writes the wall time of every timer section, with the
+ * corresponding DoF and cell throughput, to <output>.csv and <output>.json.
+ *
+ * Usage:
+ *   benchmark [--parameters=file] [--cells=8,16] [--degrees=1,2]
+ *             [--threads=1,4] [--solvers=direct,direct-sc,cg,cg-sc]
+ *             [--steps=1] [--output=benchmark]
+ *
+ * Options that are not given are taken from the parameter file. Every run
+ * uses the same load steps: --steps times the time step size of the file.
+ */
+
+#include "Solid.h"
+
+namespace {
+using namespace MLSolver;
+
+struct SolverConfiguration {
+    std::string name;
+    std::string type_lin;
+    bool use_static_condensation;
+};
+
+struct Phase {
+    std::string name;
+    unsigned int n_calls;
+    double wall_time;
+};
+
+struct Run {
+    unsigned int cellnum;
+    unsigned int degree;
+    unsigned int n_threads;
+    SolverConfiguration solver;
+    bool succeeded;
+    std::string error;
+    unsigned int n_active_cells;
+    types::global_dof_index n_dofs;
+    double wall_time;
+    std::vector<Phase> phases;
+};
+
+SolverConfiguration get_solver_configuration(const std::string &name) {
+    if (name == "direct")
+        return {name, "Direct", false};
+    if (name == "direct-sc")
+        return {name, "Direct", true};
+    if (name == "cg")
+        return {name, "CG", false};
+    if (name == "cg-sc")
+        return {name, "CG", true};
+
+    AssertThrow(false, ExcMessage("Unknown solver configuration <" + name +
+                                  ">; use direct, direct-sc, cg or cg-sc."));
+    return {};
+}
+
+std::vector<unsigned int> parse_unsigned_list(const std::string &list) {
+    std::vector<unsigned int> values;
+    for (const auto &entry : Utilities::split_string_list(list, ','))
+        values.push_back(Utilities::string_to_int(entry));
+    return values;
+}
+
+void write_csv(const std::string &filename, const std::vector<Run> &runs) {
+    std::ofstream out(filename);
+    out << "cellnum,degree,threads,solver,status,n_active_cells,n_dofs,"
+           "total_wall_time,phase,n_calls,wall_time,dofs_per_second,"
+           "cells_per_second\n";
+    for (const auto &run : runs) {
+        const std::string prefix =
+            std::to_string(run.cellnum) + ',' + std::to_string(run.degree) +
+            ',' + std::to_string(run.n_threads) + ',' + run.solver.name + ',' +
+            (run.succeeded ? "ok" : "failed") + ',' +
+            std::to_string(run.n_active_cells) + ',' +
+            std::to_string(run.n_dofs) + ',' + std::to_string(run.wall_time);
+
+        if (run.phases.empty())
+            out << prefix << ",,,,,\n";
+        for (const auto &phase : run.phases) {
+            const double work = (phase.wall_time > 0.0 ? phase.n_calls /
+                                                             phase.wall_time
+                                                       : 0.0);
+            out << prefix << ',' << phase.name << ',' << phase.n_calls << ','
+                << phase.wall_time << ',' << work * run.n_dofs << ','
+                << work * run.n_active_cells << '\n';
+        }
+    }
+}
+
+void write_json(const std::string &filename, const std::vector<Run> &runs) {
+    std::ofstream out(filename);
+    out << "{\n  \"runs\": [";
+    for (unsigned int r = 0; r < runs.size(); ++r) {
+        const Run &run = runs[r];
+        out << (r == 0 ? "\n" : ",\n") << "    {\"cellnum\": " << run.cellnum
+            << ", \"degree\": " << run.degree
+            << ", \"threads\": " << run.n_threads << ", \"solver\": \""
+            << run.solver.name << "\", \"solver_type\": \""
+            << run.solver.type_lin << "\", \"static_condensation\": "
+            << (run.solver.use_static_condensation ? "true" : "false")
+            << ", \"status\": \"" << (run.succeeded ? "ok" : "failed")
+            << "\"";
+        if (!run.succeeded) {
+            std::string error = run.error;
+            for (char &c : error)
+                if (c == '"' || c == '\\' || c == '\n')
+                    c = ' ';
+            out << ", \"error\": \"" << error << "\"";
+        }
+        out << ", \"n_active_cells\": " << run.n_active_cells
+            << ", \"n_dofs\": " << run.n_dofs
+            << ", \"wall_time\": " << run.wall_time << ", \"phases\": {";
+        for (unsigned int p = 0; p < run.phases.size(); ++p) {
+            const Phase &phase = run.phases[p];
+            const double work = (phase.wall_time > 0.0 ? phase.n_calls /
+                                                             phase.wall_time
+                                                       : 0.0);
+            out << (p == 0 ? "" : ", ") << "\"" << phase.name
+                << "\": {\"n_calls\": " << phase.n_calls
+                << ", \"wall_time\": " << phase.wall_time
+                << ", \"dofs_per_second\": " << work * run.n_dofs
+                << ", \"cells_per_second\": " << work * run.n_active_cells
+                << "}";
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+template <int dim>
+Run benchmark_one(const Parameters::AllParameters &base_parameters,
+                  const unsigned int cellnum, const unsigned int degree,
+                  const unsigned int n_threads,
+                  const SolverConfiguration &solver,
+                  const unsigned int n_steps) {
+    Run run{cellnum, degree, n_threads, solver, false, "", 0, 0, 0.0, {}};
+
+    Parameters::AllParameters parameters(base_parameters);
+    parameters.cellnum = cellnum;
+    parameters.poly_degree = degree;
+    parameters.quad_order = degree + 1;
+    parameters.type_lin = solver.type_lin;
+    parameters.use_static_condensation = solver.use_static_condensation;
+    parameters.end_time = n_steps * parameters.delta_t;
+    parameters.restart = false;
+    parameters.checkpoint_interval = 0;
+
+    MultithreadInfo::set_thread_limit(n_threads);
+
+    try {
+        Timer timer;
+        Solid<dim> solid(parameters);
+        solid.run();
+        timer.stop();
+
+        run.succeeded = true;
+        run.wall_time = timer.wall_time();
+        run.n_active_cells = solid.n_active_cells();
+        run.n_dofs = solid.n_dofs();
+
+        const std::map<std::string, double> wall_times =
+            solid.get_timer_summary(TimerOutput::total_wall_time);
+        const std::map<std::string, double> n_calls =
+            solid.get_timer_summary(TimerOutput::n_calls);
+        for (const auto &section : wall_times)
+            run.phases.push_back(
+                {section.first,
+                 static_cast<unsigned int>(n_calls.at(section.first)),
+                 section.second});
+    } catch (const std::exception &exc) {
+        run.error = exc.what();
+    }
+
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    using namespace MLSolver;
+
+    try {
+        Utilities::MPI::MPI_InitFinalize mpi_initialization(
+            argc, argv, numbers::invalid_unsigned_int);
+        AssertThrow(Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD) == 1,
+                    ExcMessage("This solver is parallelized with threads "
+                               "only. Run it on a single MPI process."));
+
+        const unsigned int dim = 3;
+
+        std::map<std::string, std::string> options = {
+            {"parameters", "../../parameters.prm"},
+            {"solvers", "direct,direct-sc,cg,cg-sc"},
+            {"steps", "1"},
+            {"output", "benchmark"}};
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument(argv[i]);
+            const std::size_t equal = argument.find('=');
+            AssertThrow(argument.compare(0, 2, "--") == 0 &&
+                            equal != std::string::npos,
+                        ExcMessage("Expected --option=value, got <" +
+                                   argument + ">."));
+            options[argument.substr(2, equal - 2)] =
+                argument.substr(equal + 1);
+        }
+
+        const Parameters::AllParameters base_parameters(options["parameters"]);
+
+        const std::vector<unsigned int> cellnums =
+            options.count("cells")
+                ? parse_unsigned_list(options["cells"])
+                : std::vector<unsigned int>{
+                      static_cast<unsigned int>(base_parameters.cellnum)};
+        const std::vector<unsigned int> degrees =
+            options.count("degrees")
+                ? parse_unsigned_list(options["degrees"])
+                : std::vector<unsigned int>{base_parameters.poly_degree};
+        const std::vector<unsigned int> thread_counts =
+            options.count("threads")
+                ? parse_unsigned_list(options["threads"])
+                : std::vector<unsigned int>{MultithreadInfo::n_cores()};
+        std::vector<SolverConfiguration> solvers;
+        for (const auto &name :
+             Utilities::split_string_list(options["solvers"], ','))
+            solvers.push_back(get_solver_configuration(name));
+        const unsigned int n_steps = Utilities::string_to_int(options["steps"]);
+
+        std::vector<Run> runs;
+        for (const unsigned int cellnum : cellnums)
+            for (const unsigned int degree : degrees)
+                for (const unsigned int n_threads : thread_counts)
+                    for (const auto &solver : solvers) {
+                        runs.push_back(benchmark_one<dim>(base_parameters,
+                                                          cellnum, degree,
+                                                          n_threads, solver,
+                                                          n_steps));
+
+                        const Run &run = runs.back();
+                        std::cout << "Benchmark: cells " << cellnum
+                                  << ", degree " << degree << ", threads "
+                                  << n_threads << ", " << solver.name << ": "
+                                  << (run.succeeded
+                                          ? std::to_string(run.wall_time) +
+                                                " s, " +
+                                                std::to_string(run.n_dofs) +
+                                                " dofs"
+                                          : "failed (" + run.error + ")")
+                                  << std::endl;
+
+                        // Rewritten after every run so that an aborted sweep
+                        // keeps its results
+                        write_csv(options["output"] + ".csv", runs);
+                        write_json(options["output"] + ".json", runs);
+                    }
+    } catch (std::exception &exc) {
+        std::cerr << std::endl
+                  << std::endl
+                  << "----------------------------------------------------"
+                  << std::endl;
+        std::cerr << "Exception on processing: " << std::endl
+                  << exc.what() << std::endl
+                  << "Aborting!" << std::endl
+                  << "----------------------------------------------------"
+                  << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cerr << std::endl
+                  << std::endl
+                  << "----------------------------------------------------"
+                  << std::endl;
+        std::cerr << "Unknown exception!" << std::endl
+                  << "Aborting!" << std::endl
+                  << "----------------------------------------------------"
+                  << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "DirectSolver.h"
+
+#include <deal.II/lac/block_sparse_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+
+#include <umfpack.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace MLSolver {
+
+DirectSolver::DirectSolver()
+    : n_rows(0), symbolic_decomposition(nullptr),
+      numeric_decomposition(nullptr), control(UMFPACK_CONTROL), n_symbolic(0),
+      n_numeric(0) {
+    umfpack_dl_defaults(control.data());
+}
+
+DirectSolver::~DirectSolver() { clear(); }
+
+void DirectSolver::clear() {
+    if (symbolic_decomposition != nullptr) {
+        umfpack_dl_free_symbolic(&symbolic_decomposition);
+        symbolic_decomposition = nullptr;
+    }
+
+    if (numeric_decomposition != nullptr) {
+        umfpack_dl_free_numeric(&numeric_decomposition);
+        numeric_decomposition = nullptr;
+    }
+
+    n_rows = 0;
+    std::vector<types::suitesparse_index>().swap(Ap);
+    std::vector<types::suitesparse_index>().swap(Ai);
+    std::vector<double>().swap(Ax);
+}
+
+template <typename MatrixType>
+void DirectSolver::factorize(const MatrixType &matrix) {
+    Assert(matrix.m() == matrix.n(), ExcNotQuadratic());
+
+    // UMFPACK expects column-compressed storage. We hand it the rows of
+    // the matrix instead and solve with the transpose, so the arrays below
+    // are in compressed row format with sorted column indices.
+    const types::global_dof_index N = matrix.m();
+    std::vector<types::suitesparse_index> new_Ap(N + 1);
+    std::vector<types::suitesparse_index> new_Ai;
+    new_Ai.reserve(Ai.size());
+    Ax.clear();
+    Ax.reserve(Ai.size());
+
+    std::vector<std::pair<types::suitesparse_index, double>> row_entries;
+    new_Ap[0] = 0;
+    for (types::global_dof_index row = 0; row < N; ++row) {
+        row_entries.clear();
+        for (auto entry = matrix.begin(row); entry != matrix.end(row); ++entry)
+            row_entries.emplace_back(entry->column(), entry->value());
+        std::sort(row_entries.begin(), row_entries.end(),
+                  [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        for (const auto &entry : row_entries) {
+            new_Ai.push_back(entry.first);
+            Ax.push_back(entry.second);
+        }
+        new_Ap[row + 1] = new_Ai.size();
+    }
+
+    const bool pattern_changed =
+        (symbolic_decomposition == nullptr) || (N != n_rows) ||
+        (new_Ap != Ap) || (new_Ai != Ai);
+
+    n_rows = N;
+    if (pattern_changed) {
+        Ap.swap(new_Ap);
+        Ai.swap(new_Ai);
+        symbolic_factorization();
+    }
+
+    numeric_factorization();
+}
+
+void DirectSolver::symbolic_factorization() {
+    if (symbolic_decomposition != nullptr)
+        umfpack_dl_free_symbolic(&symbolic_decomposition);
+    if (numeric_decomposition != nullptr) {
+        umfpack_dl_free_numeric(&numeric_decomposition);
+        numeric_decomposition = nullptr;
+    }
+
+    const types::suitesparse_index N = n_rows;
+    const int status =
+        umfpack_dl_symbolic(N, N, Ap.data(), Ai.data(), Ax.data(),
+                            &symbolic_decomposition, control.data(), nullptr);
+    AssertThrow(status == UMFPACK_OK,
+                SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_symbolic",
+                                                      status));
+    ++n_symbolic;
+}
+
+void DirectSolver::numeric_factorization() {
+    if (numeric_decomposition != nullptr)
+        umfpack_dl_free_numeric(&numeric_decomposition);
+
+    const int status =
+        umfpack_dl_numeric(Ap.data(), Ai.data(), Ax.data(),
+                           symbolic_decomposition, &numeric_decomposition,
+                           control.data(), nullptr);
+    AssertThrow(status == UMFPACK_OK,
+                SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_numeric",
+                                                      status));
+    ++n_numeric;
+}
+
+void DirectSolver::vmult(Vector<double> &dst,
+                         const Vector<double> &src) const {
+    Assert(is_factorized(), ExcNotInitialized());
+    AssertDimension(src.size(), n_rows);
+
+    dst.reinit(n_rows, true);
+    const int status = umfpack_dl_solve(
+        UMFPACK_At, Ap.data(), Ai.data(), Ax.data(), dst.begin(), src.begin(),
+        numeric_decomposition, control.data(), nullptr);
+    AssertThrow(status == UMFPACK_OK,
+                SparseDirectUMFPACK::ExcUMFPACKError("umfpack_dl_solve",
+                                                      status));
+}
+
+void DirectSolver::vmult(BlockVector<double> &dst,
+                         const BlockVector<double> &src) const {
+    tmp_src.reinit(src.size(), true);
+    tmp_src = src;
+    vmult(tmp_dst, tmp_src);
+    dst = tmp_dst;
+}
+
+template void DirectSolver::factorize(const SparseMatrix<double> &);
+template void DirectSolver::factorize(const BlockSparseMatrix<double> &);
+
+} // namespace MLSolver
@@ -0,0 +1,73 @@
+//
+//  DirectSolver.h
+//  main
+//
+
+#ifndef DirectSolver_h
+#define DirectSolver_h
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/sparse_direct.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+
+namespace MLSolver {
+using namespace dealii;
+
+// UMFPACK factorization that keeps the symbolic analysis alive between
+// calls to factorize(). The analysis is recomputed only when the sparsity
+// pattern of the matrix changes; otherwise only the numeric factorization
+// is redone.
+class DirectSolver {
+  public:
+    DirectSolver();
+    ~DirectSolver();
+
+    DirectSolver(const DirectSolver &) = delete;
+    DirectSolver &operator=(const DirectSolver &) = delete;
+
+    void clear();
+
+    // Works with SparseMatrix<double> and BlockSparseMatrix<double>.
+    template <typename MatrixType> void factorize(const MatrixType &matrix);
+
+    void vmult(Vector<double> &dst, const Vector<double> &src) const;
+
+    void vmult(BlockVector<double> &dst, const BlockVector<double> &src) const;
+
+    bool is_factorized() const { return numeric_decomposition != nullptr; }
+
+    unsigned int n_symbolic_factorizations() const {
+        return n_symbolic;
+    }
+
+    unsigned int n_numeric_factorizations() const { return n_numeric; }
+
+  private:
+    void symbolic_factorization();
+
+    void numeric_factorization();
+
+    types::global_dof_index n_rows;
+
+    std::vector<types::suitesparse_index> Ap;
+    std::vector<types::suitesparse_index> Ai;
+    std::vector<double> Ax;
+
+    void *symbolic_decomposition;
+    void *numeric_decomposition;
+
+    std::vector<double> control;
+
+    unsigned int n_symbolic;
+    unsigned int n_numeric;
+
+    mutable Vector<double> tmp_src;
+    mutable Vector<double> tmp_dst;
+};
+
+} // namespace MLSolver
+
+#endif /* DirectSolver_h */
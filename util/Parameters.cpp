@@ -1,5 +1,7 @@
 #include "Parameters.h"
 
+#include <deal.II/base/utilities.h>
+
 namespace MLSolver {
 namespace Parameters {
 
@@ -11,6 +13,15 @@ void FESystem::declare_parameters(ParameterHandler &prm) {
                           "Displacement system polynomial order");
         prm.declare_entry("Quadrature order", "3", Patterns::Integer(0),
                           "Gauss quadrature order");
+        prm.declare_entry("Colored assembly", "false", Patterns::Bool(),
+                          "Assemble color by color so that cells sharing no "
+                          "dofs are copied into the global system "
+                          "concurrently");
+        prm.declare_entry("Cache reference shape data", "false",
+                          Patterns::Bool(),
+                          "Precompute the reference shape gradients and JxW "
+                          "of every cell instead of reinitializing FEValues "
+                          "in each Newton iteration");
     }
     prm.leave_subsection();
 }
@@ -20,6 +31,8 @@ void FESystem::parse_parameters(ParameterHandler &prm) {
     {
         poly_degree = prm.get_integer("Polynomial degree");
         quad_order = prm.get_integer("Quadrature order");
+        use_colored_assembly = prm.get_bool("Colored assembly");
+        use_shape_cache = prm.get_bool("Cache reference shape data");
     }
     prm.leave_subsection();
 }
@@ -34,9 +47,28 @@ void Geometry::declare_parameters(ParameterHandler &prm) {
                           "Global grid scaling factor");
         prm.declare_entry("cell num", "12", Patterns::Integer(0.0),
                           "cooks cell num");
+        prm.declare_entry("Thickness layers", "2", Patterns::Integer(1),
+                          "Cells through the thickness of the 3-d Cook's "
+                          "membrane grid");
         prm.declare_entry("Pressure ratio p/p0", "100",
                           Patterns::Double(0.0),
                           "Ratio of applied pressure to reference pressure");
+        prm.declare_entry("Mesh file", "", Patterns::Anything(),
+                          "Mesh to read instead of generating the Cook's "
+                          "membrane grid; its boundary ids come from the "
+                          "file's physical groups");
+        prm.declare_entry(
+            "Mesh format", "auto",
+            Patterns::Selection("auto|msh|ucd|vtk|vtu|abaqus|exodusii"),
+            "Format of the mesh file (auto uses the file extension)");
+        prm.declare_entry("Mesh cache file", "", Patterns::Anything(),
+                          "Binary copy of the triangulation that is read "
+                          "instead of the mesh file while it is newer (empty "
+                          "disables the cache)");
+        prm.declare_entry("Setup cache directory", "", Patterns::Anything(),
+                          "Directory for the dof renumbering and sparsity "
+                          "pattern of every mesh, keyed by a hash of its "
+                          "connectivity (empty disables the cache)");
     }
     prm.leave_subsection();
 }
@@ -48,6 +80,11 @@ void Geometry::parse_parameters(ParameterHandler &prm) {
         scale = prm.get_double("Grid scale");
         p_p0 = prm.get_double("Pressure ratio p/p0");
         cellnum = prm.get_integer("cell num");
+        thickness_layers = prm.get_integer("Thickness layers");
+        mesh_file = prm.get("Mesh file");
+        mesh_format = prm.get("Mesh format");
+        mesh_cache_file = prm.get("Mesh cache file");
+        setup_cache_directory = prm.get("Setup cache directory");
     }
     prm.leave_subsection();
 }
@@ -60,6 +97,15 @@ void Materials::declare_parameters(ParameterHandler &prm) {
 
         prm.declare_entry("Shear modulus", "80.194e6", Patterns::Double(),
                           "Shear modulus");
+
+        prm.declare_entry("Vectorized update", "true", Patterns::Bool(),
+                          "Evaluate the constitutive law for several "
+                          "quadrature points at once using SIMD lanes");
+
+        prm.declare_entry("Tangent form", "closed form",
+                          Patterns::Selection("dense|closed form"),
+                          "Store the spatial tangent as a dense fourth-order "
+                          "tensor or apply it in closed form");
     }
     prm.leave_subsection();
 }
@@ -69,6 +115,8 @@ void Materials::parse_parameters(ParameterHandler &prm) {
     {
         nu = prm.get_double("Poisson's ratio");
         mu = prm.get_double("Shear modulus");
+        use_vectorized_update = prm.get_bool("Vectorized update");
+        tangent_form = prm.get("Tangent form");
     }
     prm.leave_subsection();
 }
@@ -89,13 +137,50 @@ void LinearSolver::declare_parameters(ParameterHandler &prm) {
         prm.declare_entry("Use static condensation", "true", Patterns::Bool(),
                           "Solve the full block system or a reduced problem");
 
+        prm.declare_entry("Fused static condensation", "true",
+                          Patterns::Bool(),
+                          "Condense the p and J dofs inside the assembly "
+                          "cell worker and keep the per-cell factors instead "
+                          "of the global p and J blocks");
+
         prm.declare_entry("Preconditioner type", "ssor",
-                          Patterns::Selection("jacobi|ssor"),
+                          Patterns::Selection("jacobi|ssor|amg|gmg"),
                           "Type of preconditioner");
 
         prm.declare_entry("Preconditioner relaxation", "0.65",
                           Patterns::Double(0.0),
                           "Preconditioner relaxation value");
+
+        prm.declare_entry("Mixed precision", "off",
+                          Patterns::Selection("off|preconditioner|solver"),
+                          "Keep a single precision copy of K_uu for the "
+                          "preconditioner, or for the whole CG solve inside "
+                          "a double precision defect correction loop");
+
+        prm.declare_entry("AMG rebuild ratio", "1.5", Patterns::Double(1.0),
+                          "Rebuild the AMG hierarchy once the linear solver "
+                          "needs this many times the iterations it took "
+                          "right after the last rebuild");
+
+        prm.declare_entry("Multigrid levels", "2", Patterns::Integer(1),
+                          "Number of levels of the geometric multigrid "
+                          "hierarchy; the Cook's membrane grid is built on "
+                          "the coarsest level and refined globally");
+
+        prm.declare_entry("Chebyshev degree", "4", Patterns::Integer(1),
+                          "Degree of the Chebyshev smoother on the multigrid "
+                          "levels");
+
+        prm.declare_entry("Matrix-free tangent", "false", Patterns::Bool(),
+                          "Apply the tangent blocks on the fly from the "
+                          "quadrature point data instead of assembling the "
+                          "tangent matrix (CG without static condensation)");
+
+        prm.declare_entry("Factorization reuse iterations", "0",
+                          Patterns::Integer(0),
+                          "Number of Newton iterations the direct solver may "
+                          "reuse an earlier factorization while the residual "
+                          "keeps decreasing (0 refactorizes every iteration)");
     }
     prm.leave_subsection();
 }
@@ -107,8 +192,16 @@ void LinearSolver::parse_parameters(ParameterHandler &prm) {
         tol_lin = prm.get_double("Residual");
         max_iterations_lin = prm.get_double("Max iteration multiplier");
         use_static_condensation = prm.get_bool("Use static condensation");
+        use_fused_condensation = prm.get_bool("Fused static condensation");
         preconditioner_type = prm.get("Preconditioner type");
         preconditioner_relaxation = prm.get_double("Preconditioner relaxation");
+        mixed_precision = prm.get("Mixed precision");
+        amg_rebuild_ratio = prm.get_double("AMG rebuild ratio");
+        multigrid_levels = prm.get_integer("Multigrid levels");
+        chebyshev_degree = prm.get_integer("Chebyshev degree");
+        use_matrix_free = prm.get_bool("Matrix-free tangent");
+        max_factorization_reuse =
+            prm.get_integer("Factorization reuse iterations");
     }
     prm.leave_subsection();
 }
@@ -127,6 +220,32 @@ void NonlinearSolver::declare_parameters(ParameterHandler &prm) {
         prm.declare_entry("Tolerance displacement", "1.0e-6",
                           Patterns::Double(0.0),
                           "Displacement error tolerance");
+
+        prm.declare_entry("Pipelined iteration", "false", Patterns::Bool(),
+                          "Overlap independent stages of the Newton "
+                          "iteration: prepare the constraints in the "
+                          "background and fuse the p/J recovery of the "
+                          "fused condensation with the QPH update");
+
+        prm.declare_entry("Nonlinear strategy", "newton",
+                          Patterns::Selection("newton|modified|bfgs"),
+                          "Full Newton reassembles the tangent in every "
+                          "iteration; modified Newton and BFGS keep it while "
+                          "the residual decreases fast enough and otherwise "
+                          "only assemble the residual");
+
+        prm.declare_entry("Tangent update ratio", "0.5",
+                          Patterns::Double(0.0, 1.0),
+                          "Modified Newton and BFGS reassemble the tangent "
+                          "once an iteration reduces the residual norm by "
+                          "less than this factor");
+
+        prm.declare_entry("Line search", "false", Patterns::Bool(),
+                          "Backtrack the Newton step until the residual norm "
+                          "decreases sufficiently");
+
+        prm.declare_entry("Max line search steps", "4", Patterns::Integer(0),
+                          "Number of times the step may be halved");
     }
     prm.leave_subsection();
 }
@@ -137,6 +256,11 @@ void NonlinearSolver::parse_parameters(ParameterHandler &prm) {
         max_iterations_NR = prm.get_integer("Max iterations Newton-Raphson");
         tol_f = prm.get_double("Tolerance force");
         tol_u = prm.get_double("Tolerance displacement");
+        use_pipelining = prm.get_bool("Pipelined iteration");
+        nonlinear_strategy = prm.get("Nonlinear strategy");
+        tangent_update_ratio = prm.get_double("Tangent update ratio");
+        use_line_search = prm.get_bool("Line search");
+        max_line_search_steps = prm.get_integer("Max line search steps");
     }
     prm.leave_subsection();
 }
@@ -149,6 +273,28 @@ void Time::declare_parameters(ParameterHandler &prm) {
 
         prm.declare_entry("Time step size", "0.1", Patterns::Double(),
                           "Time step size");
+
+        prm.declare_entry("Adaptive time stepping", "false", Patterns::Bool(),
+                          "Adapt the step size to the Newton convergence "
+                          "and retry failed steps with a smaller step");
+
+        prm.declare_entry("Minimum time step size", "1e-4",
+                          Patterns::Double(0.0),
+                          "Smallest step size before a failed step aborts "
+                          "the run");
+
+        prm.declare_entry("Maximum time step size", "0.25",
+                          Patterns::Double(0.0), "Largest step size");
+
+        prm.declare_entry("Step growth factor", "1.5", Patterns::Double(1.0),
+                          "Step size factor after an easily converged step");
+
+        prm.declare_entry("Step cut factor", "0.5", Patterns::Double(0.0, 1.0),
+                          "Step size factor after a failed step");
+
+        prm.declare_entry("Easy Newton iterations", "4", Patterns::Integer(1),
+                          "Grow the step if Newton converged within this "
+                          "many iterations");
     }
     prm.leave_subsection();
 }
@@ -158,6 +304,141 @@ void Time::parse_parameters(ParameterHandler &prm) {
     {
         end_time = prm.get_double("End time");
         delta_t = prm.get_double("Time step size");
+        use_adaptive_time_stepping = prm.get_bool("Adaptive time stepping");
+        min_delta_t = prm.get_double("Minimum time step size");
+        max_delta_t = prm.get_double("Maximum time step size");
+        step_growth_factor = prm.get_double("Step growth factor");
+        step_cut_factor = prm.get_double("Step cut factor");
+        easy_newton_iterations = prm.get_integer("Easy Newton iterations");
+    }
+    prm.leave_subsection();
+}
+
+void Output::declare_parameters(ParameterHandler &prm) {
+    prm.enter_subsection("Output");
+    {
+        prm.declare_entry("Output interval", "1", Patterns::Integer(0),
+                          "Write the solution every this many timesteps, "
+                          "starting with the initial state (0 writes none "
+                          "of them; Final output still writes the last "
+                          "one)");
+
+        prm.declare_entry("Patch subdivisions", "0", Patterns::Integer(0),
+                          "Subdivisions of each cell in the output "
+                          "(0 uses the polynomial degree)");
+
+        prm.declare_entry("Asynchronous output", "true", Patterns::Bool(),
+                          "Build patches and write files on a background "
+                          "task while the next timestep is solved");
+
+        prm.declare_entry(
+            "Compression level", "best speed",
+            Patterns::Selection("none|best speed|default|best compression"),
+            "zlib compression level of the VTU output");
+
+        prm.declare_entry("Checkpoint interval", "0", Patterns::Integer(0),
+                          "Write a restart checkpoint every this many "
+                          "timesteps (0 disables checkpointing)");
+
+        prm.declare_entry("Checkpoint file", "checkpoint.bin",
+                          Patterns::FileName(),
+                          "Binary checkpoint file written and read on "
+                          "restart");
+
+        prm.declare_entry("Restart", "false", Patterns::Bool(),
+                          "Resume from the checkpoint file instead of "
+                          "starting at t = 0");
+
+        prm.declare_entry("Telemetry file", "", Patterns::Anything(),
+                          "JSON-lines file receiving the timings, solver "
+                          "statistics and memory use of every timestep and "
+                          "Newton iteration (empty disables it)");
+
+        prm.declare_entry(
+            "Output fields", "displacement, pressure, dilatation, stress norm",
+            Patterns::MultipleSelection(
+                "displacement|pressure|dilatation|stress norm"),
+            "Fields written to the VTU output");
+
+        prm.declare_entry("Final output", "true", Patterns::Bool(),
+                          "Write the last timestep whatever the output "
+                          "interval, also when it is 0");
+
+        prm.declare_entry("Probe points", "", Patterns::Anything(),
+                          "Points of the undeformed mesh, as x,y[,z] "
+                          "separated by semicolons, at which the solution "
+                          "is sampled every timestep");
+
+        prm.declare_entry("Probe lines", "", Patterns::Anything(),
+                          "Lines of equally spaced probe points, as "
+                          "x0,y0[,z0] : x1,y1[,z1] : n separated by "
+                          "semicolons");
+
+        prm.declare_entry("Probe file", "probes.csv", Patterns::FileName(),
+                          "CSV file receiving the probe values");
+    }
+    prm.leave_subsection();
+}
+
+void Output::parse_parameters(ParameterHandler &prm) {
+    prm.enter_subsection("Output");
+    {
+        output_interval = prm.get_integer("Output interval");
+        patch_subdivisions = prm.get_integer("Patch subdivisions");
+        use_async_output = prm.get_bool("Asynchronous output");
+        compression_level = prm.get("Compression level");
+        checkpoint_interval = prm.get_integer("Checkpoint interval");
+        checkpoint_file = prm.get("Checkpoint file");
+        restart = prm.get_bool("Restart");
+        telemetry_file = prm.get("Telemetry file");
+        output_fields =
+            Utilities::split_string_list(prm.get("Output fields"), ',');
+        write_final_output = prm.get_bool("Final output");
+        probe_points = prm.get("Probe points");
+        probe_lines = prm.get("Probe lines");
+        probe_file = prm.get("Probe file");
+    }
+    prm.leave_subsection();
+}
+
+void Refinement::declare_parameters(ParameterHandler &prm) {
+    prm.enter_subsection("Adaptive refinement");
+    {
+        prm.declare_entry("Adaptive refinement", "false", Patterns::Bool(),
+                          "Refine and coarsen the mesh between timesteps");
+
+        prm.declare_entry("Refinement interval", "1", Patterns::Integer(1),
+                          "Adapt the mesh every this many timesteps");
+
+        prm.declare_entry("Refine fraction", "0.3", Patterns::Double(0.0, 1.0),
+                          "Fraction of cells with the largest indicator that "
+                          "are refined");
+
+        prm.declare_entry("Coarsen fraction", "0.03",
+                          Patterns::Double(0.0, 1.0),
+                          "Fraction of cells with the smallest indicator that "
+                          "are coarsened");
+
+        prm.declare_entry("Maximum refinement level", "2", Patterns::Integer(0),
+                          "Cells on this level are not refined further");
+
+        prm.declare_entry("Refinement indicator", "stress",
+                          Patterns::Selection("stress|kelly"),
+                          "Jumps of the cell-averaged Kirchhoff stress, or "
+                          "the Kelly estimator of the displacement");
+    }
+    prm.leave_subsection();
+}
+
+void Refinement::parse_parameters(ParameterHandler &prm) {
+    prm.enter_subsection("Adaptive refinement");
+    {
+        use_adaptive_refinement = prm.get_bool("Adaptive refinement");
+        refinement_interval = prm.get_integer("Refinement interval");
+        refine_fraction = prm.get_double("Refine fraction");
+        coarsen_fraction = prm.get_double("Coarsen fraction");
+        max_refinement_level = prm.get_integer("Maximum refinement level");
+        refinement_indicator = prm.get("Refinement indicator");
     }
     prm.leave_subsection();
 }
@@ -171,6 +452,8 @@ void AllParameters::declare_parameters(ParameterHandler &prm) {
     LinearSolver::declare_parameters(prm);
     NonlinearSolver::declare_parameters(prm);
     Time::declare_parameters(prm);
+    Output::declare_parameters(prm);
+    Refinement::declare_parameters(prm);
 }
 
 void AllParameters::parse_parameters(ParameterHandler &prm) {
@@ -180,6 +463,8 @@ void AllParameters::parse_parameters(ParameterHandler &prm) {
     LinearSolver::parse_parameters(prm);
     NonlinearSolver::parse_parameters(prm);
     Time::parse_parameters(prm);
+    Output::parse_parameters(prm);
+    Refinement::parse_parameters(prm);
 }
 
 AllParameters::AllParameters(const std::string &input_file) {
@@ -189,5 +474,13 @@ AllParameters::AllParameters(const std::string &input_file) {
     parse_parameters(prm);
 }
 
+AllParameters::AllParameters(const std::vector<std::string> &input_files) {
+    ParameterHandler prm;
+    declare_parameters(prm);
+    for (const auto &input_file : input_files)
+        prm.parse_input(input_file);
+    parse_parameters(prm);
+}
+
 } // namespace Parameters
 } // namespace MLSolver
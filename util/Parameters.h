@@ -10,6 +10,7 @@
 
 #include <deal.II/base/parameter_handler.h>
 #include <string>
+#include <vector>
 
 namespace MLSolver {
 using namespace dealii;
@@ -19,6 +20,8 @@ namespace Parameters {
 struct FESystem {
     unsigned int poly_degree;
     unsigned int quad_order;
+    bool use_colored_assembly;
+    bool use_shape_cache;
 
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
@@ -29,6 +32,11 @@ struct Geometry {
     double scale;
     double p_p0;
     int cellnum;
+    unsigned int thickness_layers;
+    std::string mesh_file;
+    std::string mesh_format;
+    std::string mesh_cache_file;
+    std::string setup_cache_directory;
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
 };
@@ -36,6 +44,8 @@ struct Geometry {
 struct Materials {
     double nu;
     double mu;
+    bool use_vectorized_update;
+    std::string tangent_form;
 
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
@@ -46,8 +56,15 @@ struct LinearSolver {
     double tol_lin;
     double max_iterations_lin;
     bool use_static_condensation;
+    bool use_fused_condensation;
     std::string preconditioner_type;
     double preconditioner_relaxation;
+    std::string mixed_precision;
+    double amg_rebuild_ratio;
+    unsigned int multigrid_levels;
+    unsigned int chebyshev_degree;
+    bool use_matrix_free;
+    unsigned int max_factorization_reuse;
 
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
@@ -57,6 +74,11 @@ struct NonlinearSolver {
     unsigned int max_iterations_NR;
     double tol_f;
     double tol_u;
+    bool use_pipelining;
+    std::string nonlinear_strategy;
+    double tangent_update_ratio;
+    bool use_line_search;
+    unsigned int max_line_search_steps;
 
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
@@ -65,6 +87,43 @@ struct NonlinearSolver {
 struct Time {
     double delta_t;
     double end_time;
+    bool use_adaptive_time_stepping;
+    double min_delta_t;
+    double max_delta_t;
+    double step_growth_factor;
+    double step_cut_factor;
+    unsigned int easy_newton_iterations;
+
+    static void declare_parameters(ParameterHandler &prm);
+    void parse_parameters(ParameterHandler &prm);
+};
+
+struct Output {
+    unsigned int output_interval;
+    unsigned int patch_subdivisions;
+    bool use_async_output;
+    std::string compression_level;
+    unsigned int checkpoint_interval;
+    std::string checkpoint_file;
+    bool restart;
+    std::string telemetry_file;
+    std::vector<std::string> output_fields;
+    bool write_final_output;
+    std::string probe_points;
+    std::string probe_lines;
+    std::string probe_file;
+
+    static void declare_parameters(ParameterHandler &prm);
+    void parse_parameters(ParameterHandler &prm);
+};
+
+struct Refinement {
+    bool use_adaptive_refinement;
+    unsigned int refinement_interval;
+    double refine_fraction;
+    double coarsen_fraction;
+    unsigned int max_refinement_level;
+    std::string refinement_indicator;
 
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
@@ -75,8 +134,12 @@ struct AllParameters : public FESystem,
                        public Materials,
                        public LinearSolver,
                        public NonlinearSolver,
-                       public Time {
+                       public Time,
+                       public Output,
+                       public Refinement {
     AllParameters(const std::string &input_file);
+    // Later files override the entries they set in the earlier ones
+    AllParameters(const std::vector<std::string> &input_files);
     static void declare_parameters(ParameterHandler &prm);
     void parse_parameters(ParameterHandler &prm);
 };
@@ -0,0 +1,91 @@
+#include "Telemetry.h"
+
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/utilities.h>
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace MLSolver {
+
+void Telemetry::open(const std::string &filename) {
+    out.open(filename);
+    AssertThrow(out, ExcMessage("Cannot open the telemetry file <" + filename +
+                                ">."));
+    out << std::setprecision(9);
+}
+
+void Telemetry::add(const std::string &key, const double value) {
+    if (!is_enabled())
+        return;
+
+    // JSON has no representation for inf and nan
+    std::ostringstream s;
+    s << std::setprecision(9);
+    if (std::isfinite(value))
+        s << value;
+    else
+        s << "null";
+    fields.emplace_back(key, s.str());
+}
+
+void Telemetry::add(const std::string &key, const unsigned long long value) {
+    if (!is_enabled())
+        return;
+
+    fields.emplace_back(key, std::to_string(value));
+}
+
+void Telemetry::add(const std::string &key, const std::string &value) {
+    if (!is_enabled())
+        return;
+
+    fields.emplace_back(key, '"' + value + '"');
+}
+
+void Telemetry::begin_phase(const std::string &name) {
+    if (!is_enabled())
+        return;
+
+    phases.emplace_back(name, Timer());
+}
+
+void Telemetry::end_phase() {
+    if (!is_enabled())
+        return;
+
+    Assert(!phases.empty(), ExcMessage("No telemetry phase is active."));
+    const std::string name = phases.back().first;
+    Timer &timer = phases.back().second;
+    timer.stop();
+    const double wall_time = timer.wall_time();
+    const double cpu_time = timer.cpu_time();
+    phases.pop_back();
+
+    add(name + "_wall", wall_time);
+    add(name + "_cpu", cpu_time);
+    add(name + "_thread_utilization",
+        wall_time > 0.0
+            ? cpu_time / (wall_time * MultithreadInfo::n_threads())
+            : 0.0);
+}
+
+void Telemetry::write_record() {
+    if (!is_enabled())
+        return;
+
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats(stats);
+    add("peak_rss_kb", static_cast<unsigned long long>(stats.VmHWM));
+
+    out << '{';
+    for (unsigned int i = 0; i < fields.size(); ++i)
+        out << (i == 0 ? "" : ", ") << '"' << fields[i].first
+            << "\": " << fields[i].second;
+    out << '}' << std::endl;
+
+    fields.clear();
+}
+
+} // namespace MLSolver
@@ -0,0 +1,60 @@
+//
+//  Telemetry.h
+//  main
+//
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/timer.h>
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MLSolver {
+using namespace dealii;
+
+// Line-delimited JSON sink for per-timestep and per-Newton-iteration
+// performance data. Fields are collected with add() and the phase timers,
+// and write_record() emits them as one JSON object per line together with
+// the peak resident set size. All calls are no-ops until open() is called.
+class Telemetry {
+  public:
+    Telemetry() = default;
+
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+
+    void open(const std::string &filename);
+
+    bool is_enabled() const { return out.is_open(); }
+
+    void add(const std::string &key, const double value);
+
+    void add(const std::string &key, const unsigned long long value);
+
+    void add(const std::string &key, const std::string &value);
+
+    // Records <name>_wall, <name>_cpu and <name>_thread_utilization, the
+    // CPU time of all threads relative to wall time times the thread limit.
+    // Phases may be nested.
+    void begin_phase(const std::string &name);
+
+    void end_phase();
+
+    void write_record();
+
+  private:
+    std::ofstream out;
+
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    std::vector<std::pair<std::string, Timer>> phases;
+};
+
+} // namespace MLSolver
+
+#endif /* Telemetry_h */